@@ -0,0 +1,256 @@
+
+//  Copyright (c) 2014 - 2020 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#ifndef DATAFLOW___EXPRESSION_H
+#define DATAFLOW___EXPRESSION_H
+
+#include "prelude.h"
+
+#include <functional>
+#include <tuple>
+#include <type_traits>
+
+namespace dataflow
+{
+/// \defgroup expression
+/// \{
+
+namespace expression_internal
+{
+// Each term evaluates itself from the values of the whole expression
+// arguments, starting with `Offset` position.
+template <typename T> struct argument
+{
+  using data_type = T;
+  using arguments = std::tuple<ref<T>>;
+
+  static constexpr std::size_t arity = 1;
+
+  template <std::size_t Offset, typename Values>
+  const T& evaluate(const Values& values) const
+  {
+    return std::get<Offset>(values);
+  }
+
+  arguments get_arguments() const
+  {
+    return arguments(x);
+  }
+
+  ref<T> x;
+};
+
+template <typename T> struct constant
+{
+  using data_type = T;
+  using arguments = std::tuple<>;
+
+  static constexpr std::size_t arity = 0;
+
+  template <std::size_t Offset, typename Values>
+  const T& evaluate(const Values&) const
+  {
+    return v;
+  }
+
+  arguments get_arguments() const
+  {
+    return arguments();
+  }
+
+  T v;
+};
+
+template <typename Op, typename X> struct unary
+{
+  using data_type = std::decay_t<decltype(
+    std::declval<Op>()(std::declval<typename X::data_type>()))>;
+  using arguments = typename X::arguments;
+
+  static constexpr std::size_t arity = X::arity;
+
+  template <std::size_t Offset, typename Values>
+  data_type evaluate(const Values& values) const
+  {
+    return Op()(x.template evaluate<Offset>(values));
+  }
+
+  arguments get_arguments() const
+  {
+    return x.get_arguments();
+  }
+
+  X x;
+};
+
+template <typename Op, typename X, typename Y> struct binary
+{
+  using data_type = std::decay_t<decltype(std::declval<Op>()(
+    std::declval<typename X::data_type>(),
+    std::declval<typename Y::data_type>()))>;
+  using arguments = decltype(std::tuple_cat(
+    std::declval<typename X::arguments>(), std::declval<typename Y::arguments>()));
+
+  static constexpr std::size_t arity = X::arity + Y::arity;
+
+  template <std::size_t Offset, typename Values>
+  data_type evaluate(const Values& values) const
+  {
+    return Op()(x.template evaluate<Offset>(values),
+                y.template evaluate<Offset + X::arity>(values));
+  }
+
+  arguments get_arguments() const
+  {
+    return std::tuple_cat(x.get_arguments(), y.get_arguments());
+  }
+
+  X x;
+  Y y;
+};
+
+struct unary_plus
+{
+  template <typename T> auto operator()(const T& x) const -> decltype(+x)
+  {
+    return +x;
+  }
+};
+}
+
+/// Lazily built composition of operators. Instead of creating a node per
+/// operator, it materializes as a single node when converted to `ref`:
+///
+///     const ref<int> y = Expr(a) * b + 1;
+///
+/// Operands are evaluated in the same order as the operators would be, but
+/// `&&` and `||` always evaluate both sides.
+template <typename Term> class expression final
+{
+public:
+  using data_type = typename Term::data_type;
+
+public:
+  explicit expression(Term term);
+
+  ref<data_type> as_ref() const;
+
+  operator ref<data_type>() const;
+
+  const Term& term() const;
+
+private:
+  Term term_;
+};
+
+template <typename T> struct is_expression : std::false_type
+{
+};
+
+template <typename Term>
+struct is_expression<expression<Term>> : std::true_type
+{
+};
+
+template <typename T>
+expression<expression_internal::argument<T>> Expr(const ref<T>& x);
+
+namespace expression_internal
+{
+// Literals become constant terms, refs become arguments
+template <typename T, typename = void> struct term_of
+{
+};
+
+template <typename T>
+struct term_of<T, typename std::enable_if<core::is_ref<T>::value>::type>
+{
+  using type = argument<core::data_type_t<T>>;
+};
+
+template <typename Term> struct term_of<expression<Term>>
+{
+  using type = Term;
+};
+
+template <typename T>
+struct term_of<T,
+               typename std::enable_if<
+                 !core::is_ref<T>::value &&
+                 core::is_flowable<core::convert_to_flowable_t<T>>::value>::type>
+{
+  using type = constant<core::convert_to_flowable_t<T>>;
+};
+
+template <typename T> using term_t = typename term_of<T>::type;
+
+template <typename Op, typename X, typename Y>
+using binary_expression_t = expression<binary<Op, term_t<X>, term_t<Y>>>;
+}
+
+#define DATAFLOW___EXPRESSION_BINARY_OPERATOR_DECLARATION(op, functor)        \
+  template <typename TermX, typename TermY>                                    \
+  expression_internal::binary_expression_t<functor,                            \
+                                           expression<TermX>,                  \
+                                           expression<TermY>>                  \
+  operator op(const expression<TermX>& x, const expression<TermY>& y);         \
+                                                                               \
+  template <typename TermX, typename Y>                                        \
+  expression_internal::binary_expression_t<functor, expression<TermX>, Y>      \
+  operator op(const expression<TermX>& x, const Y& y);                         \
+                                                                               \
+  template <typename X, typename TermY>                                        \
+  expression_internal::binary_expression_t<functor, X, expression<TermY>>      \
+  operator op(const X& x, const expression<TermY>& y);
+
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DECLARATION(+, std::plus<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DECLARATION(-, std::minus<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DECLARATION(*, std::multiplies<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DECLARATION(/, std::divides<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DECLARATION(%, std::modulus<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DECLARATION(==, std::equal_to<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DECLARATION(!=, std::not_equal_to<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DECLARATION(<, std::less<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DECLARATION(<=, std::less_equal<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DECLARATION(>, std::greater<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DECLARATION(>=, std::greater_equal<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DECLARATION(&&, std::logical_and<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DECLARATION(||, std::logical_or<>)
+
+#undef DATAFLOW___EXPRESSION_BINARY_OPERATOR_DECLARATION
+
+template <typename Term>
+expression<expression_internal::unary<std::negate<>, Term>>
+operator-(const expression<Term>& x);
+
+template <typename Term>
+expression<expression_internal::unary<expression_internal::unary_plus, Term>>
+operator+(const expression<Term>& x);
+
+template <typename Term>
+expression<expression_internal::unary<std::logical_not<>, Term>>
+operator!(const expression<Term>& x);
+
+/// \}
+} // dataflow
+
+#include "expression.inl"
+
+#endif // DATAFLOW___EXPRESSION_H
@@ -0,0 +1,181 @@
+
+//  Copyright (c) 2014 - 2020 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+
+#if !defined(DATAFLOW___EXPRESSION_H)
+#error '.inl' file can't be included directly. Use 'expression.h' instead
+#endif
+
+namespace dataflow
+{
+namespace expression_internal
+{
+template <typename Term> class policy
+{
+public:
+  explicit policy(const Term& term)
+  : term_(term)
+  {
+  }
+
+  static std::string label()
+  {
+    return "expression";
+  }
+
+  template <typename... Xs>
+  typename Term::data_type calculate(const Xs&... xs) const
+  {
+    return term_.template evaluate<0>(std::forward_as_tuple(xs...));
+  }
+
+private:
+  Term term_;
+};
+
+template <typename T>
+typename std::enable_if<core::is_ref<T>::value, term_t<T>>::type
+make_term(const T& x)
+{
+  return term_t<T>{static_cast<const ref<core::data_type_t<T>>&>(x)};
+}
+
+template <typename Term> const Term& make_term(const expression<Term>& x)
+{
+  return x.term();
+}
+
+template <typename T>
+typename std::enable_if<!core::is_ref<T>::value, term_t<T>>::type
+make_term(const T& v)
+{
+  return term_t<T>{v};
+}
+
+template <typename Op, typename X, typename Y>
+binary_expression_t<Op, X, Y> make_binary(const X& x, const Y& y)
+{
+  return binary_expression_t<Op, X, Y>({make_term(x), make_term(y)});
+}
+
+template <typename T, typename Term, std::size_t... Is>
+ref<T> materialize(const Term& term,
+                   const typename Term::arguments& args,
+                   std::index_sequence<Is...>)
+{
+  return core::Lift(policy<Term>(term), std::get<Is>(args)...);
+}
+}
+
+template <typename Term>
+expression<Term>::expression(Term term)
+: term_(std::move(term))
+{
+}
+
+template <typename Term>
+ref<typename expression<Term>::data_type> expression<Term>::as_ref() const
+{
+  return expression_internal::materialize<data_type>(
+    term_,
+    term_.get_arguments(),
+    std::make_index_sequence<Term::arity>());
+}
+
+template <typename Term>
+expression<Term>::operator ref<data_type>() const
+{
+  return as_ref();
+}
+
+template <typename Term> const Term& expression<Term>::term() const
+{
+  return term_;
+}
+
+template <typename T>
+expression<expression_internal::argument<T>> Expr(const ref<T>& x)
+{
+  return expression<expression_internal::argument<T>>(
+    expression_internal::argument<T>{x});
+}
+
+#define DATAFLOW___EXPRESSION_BINARY_OPERATOR_DEFINITION(op, functor)         \
+  template <typename TermX, typename TermY>                                    \
+  expression_internal::binary_expression_t<functor,                            \
+                                           expression<TermX>,                  \
+                                           expression<TermY>>                  \
+  operator op(const expression<TermX>& x, const expression<TermY>& y)          \
+  {                                                                            \
+    return expression_internal::make_binary<functor>(x, y);                    \
+  }                                                                            \
+                                                                               \
+  template <typename TermX, typename Y>                                        \
+  expression_internal::binary_expression_t<functor, expression<TermX>, Y>      \
+  operator op(const expression<TermX>& x, const Y& y)                          \
+  {                                                                            \
+    return expression_internal::make_binary<functor>(x, y);                    \
+  }                                                                            \
+                                                                               \
+  template <typename X, typename TermY>                                        \
+  expression_internal::binary_expression_t<functor, X, expression<TermY>>      \
+  operator op(const X& x, const expression<TermY>& y)                          \
+  {                                                                            \
+    return expression_internal::make_binary<functor>(x, y);                    \
+  }
+
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DEFINITION(+, std::plus<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DEFINITION(-, std::minus<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DEFINITION(*, std::multiplies<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DEFINITION(/, std::divides<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DEFINITION(%, std::modulus<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DEFINITION(==, std::equal_to<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DEFINITION(!=, std::not_equal_to<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DEFINITION(<, std::less<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DEFINITION(<=, std::less_equal<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DEFINITION(>, std::greater<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DEFINITION(>=, std::greater_equal<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DEFINITION(&&, std::logical_and<>)
+DATAFLOW___EXPRESSION_BINARY_OPERATOR_DEFINITION(||, std::logical_or<>)
+
+#undef DATAFLOW___EXPRESSION_BINARY_OPERATOR_DEFINITION
+
+template <typename Term>
+expression<expression_internal::unary<std::negate<>, Term>>
+operator-(const expression<Term>& x)
+{
+  return expression<expression_internal::unary<std::negate<>, Term>>(
+    {x.term()});
+}
+
+template <typename Term>
+expression<expression_internal::unary<expression_internal::unary_plus, Term>>
+operator+(const expression<Term>& x)
+{
+  return expression<
+    expression_internal::unary<expression_internal::unary_plus, Term>>(
+    {x.term()});
+}
+
+template <typename Term>
+expression<expression_internal::unary<std::logical_not<>, Term>>
+operator!(const expression<Term>& x)
+{
+  return expression<expression_internal::unary<std::logical_not<>, Term>>(
+    {x.term()});
+}
+}
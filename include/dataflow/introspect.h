@@ -194,6 +194,8 @@ DATAFLOW___EXPORT dependency_graph::vertices_size_type num_changed_nodes();
 
 DATAFLOW___EXPORT dependency_graph::vertices_size_type num_updated_nodes();
 
+DATAFLOW___EXPORT bool is_graph_frozen();
+
 DATAFLOW___EXPORT std::size_t memory_consumption();
 
 /// \name Data nodes properties
@@ -188,6 +188,14 @@ ref<T> introspect::Log(const ref<T>& x, const std::string& l)
     {
       return "introspect-log";
     }
+    static bool concurrent()
+    {
+      return false;
+    }
+    static bool retainable()
+    {
+      return false;
+    }
     T calculate(const T& v)
     {
       std::clog << "[t=" << current_time() << "] " << prefix_ << " = "
@@ -79,6 +79,10 @@ public:
   bool operator==(const list& other) const;
   bool operator!=(const list& other) const;
 
+  /// Checks in O(1) whether both lists share the same data. Lists which are
+  /// equal, but were built independently, are not identical.
+  bool identical(const list& other) const;
+
   list insert(integer idx, const T& v) const;
 
   list erase(integer idx) const;
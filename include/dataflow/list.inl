@@ -112,6 +112,11 @@ template <typename T> bool list<T>::operator!=(const list& other) const
   return !(*this == other);
 }
 
+template <typename T> bool list<T>::identical(const list& other) const
+{
+  return data_.identity() == other.data_.identity();
+}
+
 template <typename T> list<T> list<T>::insert(integer idx, const T& v) const
 {
   return data_.insert(list_internal::insert_index(*this, idx), v);
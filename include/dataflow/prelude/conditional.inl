@@ -22,13 +22,66 @@
 
 #include "comparison.h"
 
+#include "core/internal/node_switch.h"
+#include "core/internal/node_switch_activator.h"
+
+#include <vector>
+
+namespace dataflow
+{
+namespace detail
+{
+template <typename T, typename U>
+void collect_switch_cases(std::vector<internal::ref>&,
+                          std::vector<internal::ref>& alternatives,
+                          const std::pair<std::true_type, ref<U>>& default_case)
+{
+  alternatives.push_back(default_case.second);
+}
+
+template <typename T, typename U, typename... Cases>
+void collect_switch_cases(std::vector<internal::ref>& keys,
+                          std::vector<internal::ref>& alternatives,
+                          const std::pair<ref<T>, ref<U>>& first_case,
+                          const Cases&... other_cases)
+{
+  keys.push_back(first_case.first);
+  alternatives.push_back(first_case.second);
+
+  collect_switch_cases<T, U>(keys, alternatives, other_cases...);
+}
+
+// Unlike a chain of `If()`, the keys are compared by a single activator, and
+// changing the selected case (de)activates just two alternatives
+template <typename T, typename U, typename... Cases>
+ref<U> make_switch(const ref<T>& x, const Cases&... cases)
+{
+  std::vector<internal::ref> keys;
+  std::vector<internal::ref> alternatives;
+
+  keys.reserve(sizeof...(Cases) - 1);
+  alternatives.reserve(sizeof...(Cases));
+
+  collect_switch_cases<T, U>(keys, alternatives, cases...);
+
+  return core::ref_base<U>(
+    internal::node_switch<U>::create(
+      internal::node_switch_activator<T>::create(x, keys.data(), keys.size()),
+      alternatives.data(),
+      alternatives.size(),
+      false),
+    internal::ref::ctor_guard);
+}
+}
+}
+
 template <typename T, typename U>
 dataflow::ref<U>
 dataflow::Switch(const ref<T>& x,
                  const std::pair<ref<T>, ref<U>>& first_case,
                  const std::pair<std::true_type, ref<U>>& default_case)
 {
-  return If(x == first_case.first, first_case.second, default_case.second);
+  return detail::make_switch<T, U>(x, first_case, default_case);
 }
 
 template <typename T, typename U, typename... Cases>
@@ -36,8 +89,7 @@ dataflow::ref<U> dataflow::Switch(const ref<T>& x,
                                   const std::pair<ref<T>, ref<U>>& first_case,
                                   const Cases&... other_cases)
 {
-  return If(
-    x == first_case.first, first_case.second, Switch(x, other_cases...));
+  return detail::make_switch<T, U>(x, first_case, other_cases...);
 }
 
 template <typename FArgT, typename FArgU>
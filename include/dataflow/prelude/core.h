@@ -31,6 +31,7 @@
 #include <dataflow/utility/std_future.h>
 
 #include <functional>
+#include <memory>
 #include <string>
 #include <type_traits>
 
@@ -42,6 +43,13 @@
 
 namespace dataflow
 {
+namespace internal
+{
+class input_queue;
+class posted_input;
+template <typename T> class published_slot;
+}
+
 /// \defgroup core
 /// \ingroup prelude
 /// \{
@@ -131,20 +139,100 @@ public:
   const T& operator*() const;
 };
 
+/// Thread-safe view of a published value (see `Publish()`). It can be copied
+/// to and used by any thread, and stays valid after the engine is gone.
+template <typename T> class published_reader final
+{
+  template <typename> friend class published;
+
+public:
+  /// Returns the latest value published by the engine. Never blocks.
+  T load() const;
+
+  /// Returns the number of values published so far.
+  std::size_t version() const;
+
+private:
+  explicit published_reader(
+    std::shared_ptr<const internal::published_slot<T>> p_slot);
+
+private:
+  std::shared_ptr<const internal::published_slot<T>> p_slot_;
+};
+
+template <typename T> class published final : public ref<T>
+{
+public:
+  explicit published(const internal::ref& r, internal::ref::ctor_guard_t);
+
+  const T& operator*() const;
+
+  published_reader<T> reader() const;
+};
+
+template <typename T> class var;
+
+/// Owns the dependency graph and performs the updates. An engine serves the
+/// thread it is created on, and every thread can run its own engine. Nodes
+/// must not be shared between threads, since each engine has its own graph.
+///
 class DATAFLOW___EXPORT Engine
 {
   DATAFLOW___EXPORT friend ref<bool> Timeout(const arg<integer>& interval_msec,
                                              dtime t0);
 
 public:
-  Engine(engine_options options = engine_options::fully_optimized);
+  Engine(engine_options options = engine_options::fully_optimized,
+         std::size_t retention_period = 64);
   virtual ~Engine();
 
+  /// Thread-safe input ingestion
+  ///
+  /// `Post()` can be called from any thread and never blocks. The posted
+  /// inputs are applied by `Drain()` on the engine thread in the order they
+  /// have been posted, each of them in its own update. With
+  /// `engine_options::input_conflation`, only the latest value posted to each
+  /// variable is applied, and all the inputs are applied in a single update.
+  /// The variables and signals must stay alive until their inputs are
+  /// drained. Within a `Transaction`, `Drain()` only schedules the inputs, so
+  /// they all go to the single update at the end of the transaction, and a
+  /// variable gets only the latest value posted to it.
+  /// \{
+  template <typename T> void Post(const var<T>& x, T value);
+  void Post(const sig& s);
+  void Drain();
+  /// \}
+
 protected:
   static Engine* engine_();
 
 private:
   virtual ref<bool> timeout_(const ref<integer>& interval_msec, dtime t0);
+
+  void post_(std::unique_ptr<internal::posted_input> p_input);
+
+private:
+  const std::unique_ptr<internal::input_queue> p_inputs_;
+};
+
+/// A scope object that groups variable assignments and signal firings into a
+/// single update. While a transaction is open, changed variables and fired
+/// signals are only scheduled; the pending updates are performed in one pass
+/// when the outermost transaction is closed. Transactions can be nested.
+/// A transaction closed by an exception doesn't perform the updates, they are
+/// left for the next update.
+///
+class DATAFLOW___EXPORT Transaction final
+{
+public:
+  Transaction();
+  ~Transaction() noexcept(false);
+
+  Transaction(const Transaction&) = delete;
+  Transaction& operator=(const Transaction&) = delete;
+
+private:
+  const int uncaught_exceptions_;
 };
 
 namespace core
@@ -168,6 +256,7 @@ protected:
   var_base(DATAFLOW_VAR_CONST var_base& other);
 
   void set_value_(const T& v) DATAFLOW_VAR_CONST;
+  void set_value_(T&& v) DATAFLOW_VAR_CONST;
 
   template <typename Patch> void set_patch_(const Patch& patch);
 };
@@ -192,6 +281,13 @@ public:
 
     return *this;
   }
+
+  DATAFLOW_VAR_CONST var& operator=(T&& v) DATAFLOW_VAR_CONST
+  {
+    core::var_base<T>::set_value_(std::move(v));
+
+    return *this;
+  }
 };
 
 template <typename T> using init_function = std::function<ref<T>(dtime)>;
@@ -653,6 +749,29 @@ template <typename Policy,
             decltype(std::declval<Policy>().calculate(std::declval<Xs>()...))>>
 ref<T> Lift(const ref<Xs>&... xs);
 
+/// Same as `Lift`, but the node remembers a few latest results along with
+/// their arguments, and reuses them instead of calling the policy again.
+template <typename F,
+          typename X,
+          typename T = typename std::result_of<F(const X&)>::type>
+ref<T> LiftMemo(const std::string& label, const ref<X>& x, F func);
+
+template <
+  typename Policy,
+  typename X,
+  typename... Xs,
+  typename T = std20::remove_cvref_t<decltype(std::declval<Policy>().calculate(
+    std::declval<X>(), std::declval<Xs>()...))>>
+ref<T> LiftMemo(Policy policy, const ref<X>& x, const ref<Xs>&... xs);
+
+template <
+  typename Policy,
+  typename X,
+  typename... Xs,
+  typename T = std20::remove_cvref_t<decltype(std::declval<Policy>().calculate(
+    std::declval<X>(), std::declval<Xs>()...))>>
+ref<T> LiftMemo(const ref<X>& x, const ref<Xs>&... xs);
+
 template <typename Policy,
           typename... Xs,
           typename T = std20::remove_cvref_t<
@@ -665,6 +784,27 @@ template <typename Policy,
             decltype(std::declval<Policy>().calculate(std::declval<Xs>()...))>>
 ref<T> LiftUpdater(const ref<Xs>&... xs);
 
+/// Same as `Lift`, but `calculate()` is called on a thread pool, so a slow
+/// policy doesn't hold the update back. The node has the default value until
+/// the first result is published. Results are published at the start of the
+/// next update, or by `Engine::Drain()` if nothing else triggers an update,
+/// and the results of calculations outdated by newer arguments are dropped.
+/// The policy is copied for every calculation, and must not rely on anything
+/// but its arguments. The engine destructor drops the calculations that
+/// haven't started yet, but waits for the running ones, so a policy must not
+/// block indefinitely (e.g. by reading the console with nothing to read).
+template <typename Policy,
+          typename... Xs,
+          typename T = std20::remove_cvref_t<
+            decltype(std::declval<Policy>().calculate(std::declval<Xs>()...))>>
+ref<T> LiftAsync(Policy policy, const ref<Xs>&... xs);
+
+template <typename Policy,
+          typename... Xs,
+          typename T = std20::remove_cvref_t<
+            decltype(std::declval<Policy>().calculate(std::declval<Xs>()...))>>
+ref<T> LiftAsync(const ref<Xs>&... xs);
+
 template <
   typename Policy,
   typename X,
@@ -749,6 +889,10 @@ val<T> Main(F f);
 
 template <typename T> val<T> Main(ref<T> x);
 
+/// Same as `Main()`, but the values of `x` can also be read by other threads
+/// through `published<T>::reader()`, without stopping the engine.
+template <typename T> published<T> Publish(ref<T> x);
+
 // Conditional functions
 
 template <typename T,
@@ -21,13 +21,16 @@
 #endif
 
 #include "core/internal/config.h"
+#include "core/internal/node_async.h"
 #include "core/internal/node_compound.h"
 #include "core/internal/node_const.h"
 #include "core/internal/node_if.h"
 #include "core/internal/node_if_activator.h"
 #include "core/internal/node_main.h"
+#include "core/internal/node_memo_n_ary.h"
 #include "core/internal/node_n_ary.h"
 #include "core/internal/node_patcher_n_ary.h"
+#include "core/internal/node_publish.h"
 #include "core/internal/node_recursion.h"
 #include "core/internal/node_recursion_activator.h"
 #include "core/internal/node_selector.h"
@@ -38,6 +41,7 @@
 #include "core/internal/node_snapshot_activator.h"
 #include "core/internal/node_updater_n_ary.h"
 #include "core/internal/node_var.h"
+#include "core/internal/posted_input.h"
 
 #include <sstream>
 
@@ -97,6 +101,57 @@ template <typename T> const T& val<T>::operator*() const
   return this->template value<T>();
 }
 
+// published_reader
+
+template <typename T> T published_reader<T>::load() const
+{
+  return p_slot_->load();
+}
+
+template <typename T> std::size_t published_reader<T>::version() const
+{
+  return p_slot_->version();
+}
+
+template <typename T>
+published_reader<T>::published_reader(
+  std::shared_ptr<const internal::published_slot<T>> p_slot)
+: p_slot_(std::move(p_slot))
+{
+}
+
+// published
+
+template <typename T>
+published<T>::published(const internal::ref& r, internal::ref::ctor_guard_t)
+: ref<T>(core::ref_base<T>(r, internal::ref::ctor_guard))
+{
+}
+
+template <typename T> const T& published<T>::operator*() const
+{
+  return this->template value<T>();
+}
+
+template <typename T> published_reader<T> published<T>::reader() const
+{
+  DATAFLOW___CHECK_PRECONDITION(
+    dynamic_cast<const internal::node_publish<T>*>(this->get_()));
+
+  return published_reader<T>(
+    static_cast<const internal::node_publish<T>*>(this->get_())->slot());
+}
+
+// Engine
+
+template <typename T> void Engine::Post(const var<T>& x, T value)
+{
+  // Only the id is taken, since the reference count of `x` is not
+  // thread-safe
+  post_(std::unique_ptr<internal::posted_input>(
+    new internal::posted_value<T>(x.id(), std::move(value))));
+}
+
 namespace core
 {
 // var
@@ -134,9 +189,34 @@ void var_base<T>::set_value_(const T& v) DATAFLOW_VAR_CONST
     dynamic_cast<const internal::node_var<T>*>(this->get_()));
 
   const auto p_var = static_cast<const internal::node_var<T>*>(this->get_());
+  const bool pending = p_var->has_pending_value();
 
   if (p_var->set_next_value(v))
+  {
+    // Drops the patch of an earlier change that hasn't been published yet
+    if (pending)
+      this->reset_metadata_();
+
+    this->schedule_();
+  }
+}
+
+template <typename T>
+void var_base<T>::set_value_(T&& v) DATAFLOW_VAR_CONST
+{
+  DATAFLOW___CHECK_PRECONDITION(
+    dynamic_cast<const internal::node_var<T>*>(this->get_()));
+
+  const auto p_var = static_cast<const internal::node_var<T>*>(this->get_());
+  const bool pending = p_var->has_pending_value();
+
+  if (p_var->set_next_value(std::move(v)))
+  {
+    if (pending)
+      this->reset_metadata_();
+
     this->schedule_();
+  }
 }
 
 template <typename T>
@@ -147,12 +227,16 @@ void var_base<T>::set_patch_(const Patch& patch)
     dynamic_cast<const internal::node_var<T>*>(this->get_()));
 
   const auto p_var = static_cast<const internal::node_var<T>*>(this->get_());
+  const bool pending = p_var->has_pending_value();
 
   if (p_var->set_next_value(patch.apply(p_var->next_value())))
   {
-
-    this->set_metadata(std::unique_ptr<const internal::metadata>(
-      new internal::patch_metadata<Patch>{patch}));
+    // A patch describes the change of the current value, so the var patched
+    // or assigned again before the update is updated as a whole
+    if (pending)
+      this->reset_metadata_();
+    else
+      this->template emplace_metadata<internal::patch_metadata<Patch>>(patch);
 
     this->schedule_();
   }
@@ -339,6 +423,50 @@ ref<T> core::Lift(const ref<Xs>&... xs)
   return Lift<Policy>(Policy(), xs...);
 }
 
+template <typename F, typename X, typename T>
+ref<T> core::LiftMemo(const std::string& label, const ref<X>& x, F func)
+{
+  class policy
+  {
+  public:
+    policy(const std::string& label, const F& func)
+    : label_(label)
+    , func_(func)
+    {
+    }
+
+    std::string label() const
+    {
+      return label_;
+    }
+
+    T calculate(const X& v) const
+    {
+      return func_(v);
+    };
+
+  private:
+    std::string label_;
+    F func_;
+  };
+
+  return LiftMemo(policy(label, func), x);
+}
+
+template <typename Policy, typename X, typename... Xs, typename T>
+ref<T> core::LiftMemo(Policy policy, const ref<X>& x, const ref<Xs>&... xs)
+{
+  return ref_base<T>(internal::node_memo_n_ary<Policy, T, X, Xs...>::create(
+                       std::move(policy), x, xs...),
+                     internal::ref::ctor_guard);
+}
+
+template <typename Policy, typename X, typename... Xs, typename T>
+ref<T> core::LiftMemo(const ref<X>& x, const ref<Xs>&... xs)
+{
+  return LiftMemo<Policy>(Policy(), x, xs...);
+}
+
 namespace core
 {
 namespace detail
@@ -370,6 +498,20 @@ ref<T> core::LiftUpdater(const ref<Xs>&... xs)
   return LiftUpdater(Policy(), xs...);
 }
 
+template <typename Policy, typename... Xs, typename T>
+ref<T> core::LiftAsync(Policy policy, const ref<Xs>&... xs)
+{
+  return ref_base<T>(internal::node_async<Policy, T, Xs...>::create(
+                       std::move(policy), xs...),
+                     internal::ref::ctor_guard);
+}
+
+template <typename Policy, typename... Xs, typename T>
+ref<T> core::LiftAsync(const ref<Xs>&... xs)
+{
+  return LiftAsync(Policy(), xs...);
+}
+
 template <typename Policy, typename X, typename... Xs, typename T>
 ref<T> core::LiftPuller(Policy policy, const ref<X>& x, const ref<Xs>&... xs)
 {
@@ -530,6 +672,12 @@ template <typename T> dataflow::val<T> dataflow::Main(ref<T> x)
   return Main([x](dtime) { return x; });
 }
 
+template <typename T> dataflow::published<T> dataflow::Publish(ref<T> x)
+{
+  return published<T>(internal::node_publish<T>::create(x),
+                      internal::ref::ctor_guard);
+}
+
 template <typename T, typename U, typename FwT, typename>
 dataflow::ref<FwT> dataflow::If(const ref<bool>& x, const T& y, const U& z)
 {
@@ -24,10 +24,60 @@ namespace dataflow
 /// \ingroup prelude
 /// \{
 
+/// Engine configuration flags.
+///
+/// `parallel_update` makes the engine update independent nodes on a pool of
+/// worker threads. Only nodes that explicitly allow it (e.g. lifted nodes
+/// whose policies don't define `concurrent()` returning `false`) are updated
+/// concurrently, so policies of such nodes must be thread-safe. The results
+/// are the same as with the sequential update.
+///
+/// `warm_deactivation` makes deactivated variables and lifted nodes keep their
+/// values for a while (see the `retention_period` parameter of `Engine`). When
+/// such a node gets activated again and none of its dependencies has changed
+/// in between, its value is reused instead of being recalculated. Nodes whose
+/// policies define `retainable()` returning `false`, as well as `LiftUpdater`
+/// nodes, whose values are accumulated state, are not retained.
+///
+/// `hash_consing` makes structurally identical nodes share a single vertex.
+/// Constants of hashable types with equal values, as well as lifted nodes
+/// with stateless policies of the same type and the same arguments, are
+/// created only once.
+///
+/// `constant_folding` makes lifted nodes whose arguments are all constants
+/// calculate their values right away and become constants themselves.
+///
+/// `chain_fusion` merges chains of lifted nodes into single vertices when
+/// they get activated by an eager node (e.g. `Main()`). A node is merged into
+/// its consumer if the consumer is its only user and the consumer has no
+/// other arguments. The merged nodes keep calculating their values, but they
+/// don't take part in scheduling anymore.
+///
+/// `frozen_graph` makes the engine snapshot the active graph once it has kept
+/// its structure over a few consecutive pumps: one at first, twice as many
+/// after every thaw of a frozen graph (up to 64), and half as many after
+/// every 64 pumps a snapshot survives. The snapshot keeps the vertices in a
+/// flat array in their update order, and the vertices to be updated are found
+/// by scanning a bitset, which bypasses the topological list. Any change of
+/// the graph structure (e.g. by `If()`) thaws the graph transparently. Frozen
+/// graphs are updated sequentially, regardless of `parallel_update`.
+///
+/// `input_conflation` makes `Engine::Drain()` apply only the latest value
+/// posted to each variable, dropping the earlier ones, and apply all the
+/// inputs in a single update rather than one update per input. Signals are
+/// never dropped, but a signal posted several times fires once.
+///
 enum class engine_options
 {
   nothing = 0x00,
   straight_update_optimization = 0x01,
+  parallel_update = 0x02,
+  warm_deactivation = 0x04,
+  hash_consing = 0x08,
+  constant_folding = 0x10,
+  chain_fusion = 0x20,
+  frozen_graph = 0x40,
+  input_conflation = 0x80,
   fully_optimized = 0x01,
 };
 
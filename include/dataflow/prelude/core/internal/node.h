@@ -24,6 +24,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <new>
 #include <string>
 #include <utility>
 
@@ -70,6 +71,17 @@ inline update_status& operator&=(update_status& lhs, update_status rhs)
   return lhs = lhs & rhs;
 }
 
+class node;
+class nodes_factory;
+class pumpa;
+
+/// Non-virtual entry point updating a node of a known dynamic type.
+using update_function = update_status (*)(node* p_node,
+                                          node_id id,
+                                          bool initialized,
+                                          const node** p_args,
+                                          std::size_t args_count);
+
 class metadata
 {
 public:
@@ -78,6 +90,9 @@ public:
 
 class DATAFLOW___EXPORT node
 {
+  friend class nodes_factory;
+  friend class pumpa;
+
 public:
   void activate(node_id id, const discrete_time& t0)
   {
@@ -130,8 +145,9 @@ public:
   }
 
   node()
+  : p_metadata_(nullptr)
 #ifndef NDEBUG
-  : activation_count_()
+  , activation_count_()
   , deactivation_count_()
 #endif
   {
@@ -145,10 +161,33 @@ public:
 
 protected:
   static const discrete_time& ticks_();
-  static void set_metadata(const node* p_node,
-                           std::shared_ptr<const metadata> p_metadata);
-  static const std::shared_ptr<const metadata>&
-  get_metadata(const node* p_node);
+
+  // Metadata lives until the end of the current pump iteration, the memory
+  // for it is allocated from an arena that is reset all at once.
+  template <typename Metadata, typename... Args>
+  static void emplace_metadata(const node* p_node, Args&&... args)
+  {
+    const auto p_metadata =
+      ::new (allocate_metadata_(sizeof(Metadata), alignof(Metadata)))
+        Metadata(std::forward<Args>(args)...);
+
+    set_metadata_(p_node, p_metadata, true);
+  }
+
+  static void set_metadata(const node* p_node, const metadata* p_metadata)
+  {
+    set_metadata_(p_node, p_metadata, false);
+  }
+
+  static const metadata* get_metadata(const node* p_node)
+  {
+    return p_node->p_metadata_;
+  }
+
+private:
+  static void* allocate_metadata_(std::size_t size, std::size_t alignment);
+  static void
+  set_metadata_(const node* p_node, const metadata* p_metadata, bool owned);
 
 private:
   virtual void activate_(node_id id, const discrete_time& t0)
@@ -171,6 +210,7 @@ private:
   virtual std::pair<std::size_t, std::size_t> mem_info_() const = 0;
 
 private:
+  mutable const metadata* p_metadata_;
 #ifndef NDEBUG
   std::size_t activation_count_;
   std::size_t deactivation_count_;
@@ -0,0 +1,240 @@
+
+//  Copyright (c) 2014 - 2021 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "dataflow++_export.h"
+
+#include "config.h"
+#include "node_t.h"
+#include "nodes_factory.h"
+#include "posted_input.h"
+#include "ref.h"
+
+#include <dataflow/utility/std_future.h>
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <utility>
+
+namespace dataflow
+{
+namespace internal
+{
+DATAFLOW___EXPORT void
+run_node_async(std::function<std::unique_ptr<posted_input>()> f);
+
+/// Node calculating its value on another thread. The arguments are copied
+/// and handed over to the policy along with a copy of the policy itself, and
+/// the result is handed back to the engine to be published at the start of
+/// the next pump. Until the first result arrives, the node has the default
+/// value.
+///
+/// Every new calculation cancels the previous one: its result is dropped, and
+/// so is the calculation itself if it hasn't started yet. Deactivation
+/// cancels the pending calculation as well.
+template <typename Policy, typename T, typename... Xs>
+class node_async final : public node_t<T>, public Policy
+{
+  friend class nodes_factory;
+
+private:
+  struct token
+  {
+    token()
+    : generation(0)
+    {
+    }
+
+    std::atomic<std::size_t> generation;
+  };
+
+  class result final : public posted_input
+  {
+  public:
+    explicit result(node_id id,
+                    std::weak_ptr<const token> p_token,
+                    std::size_t generation,
+                    T value)
+    : posted_input(id)
+    , p_token_(std::move(p_token))
+    , generation_(generation)
+    , value_(std::move(value))
+    {
+    }
+
+    virtual bool expired() const override
+    {
+      return is_stale(p_token_, generation_);
+    }
+
+    virtual bool conflatable() const override
+    {
+      return false;
+    }
+
+    virtual bool apply(const node* p_node) override
+    {
+      static_cast<const node_async*>(p_node)->publish_(std::move(value_));
+
+      return true;
+    }
+
+  private:
+    const std::weak_ptr<const token> p_token_;
+    const std::size_t generation_;
+    T value_;
+  };
+
+public:
+  static ref create(Policy policy, ref_t<Xs>... xs)
+  {
+    DATAFLOW___CHECK_PRECONDITION(
+      check_all_of(xs.template is_of_type<Xs>()...));
+
+    const std::array<node_id, sizeof...(Xs)> args = {{xs.id()...}};
+
+    return nodes_factory::create<node_async<Policy, T, Xs...>>(
+      &args[0], args.size(), node_flags::none, std::move(policy));
+  }
+
+private:
+  explicit node_async(Policy policy)
+  : Policy(std::move(policy))
+  , p_token_(std::make_shared<token>())
+  , args_()
+  , pending_()
+  , has_pending_(false)
+  {
+  }
+
+  static bool is_stale(const std::weak_ptr<const token>& p_token,
+                       std::size_t generation)
+  {
+    const auto p = p_token.lock();
+
+    return !p || p->generation.load(std::memory_order_relaxed) != generation;
+  }
+
+  template <std::size_t... Is>
+  bool same_args_(const node** p_args, const std14::index_sequence<Is...>&)
+  {
+    return check_all_of(is_same_value(std::get<Is>(args_),
+                                      extract_node_value<Xs>(p_args[Is]))...);
+  }
+
+  template <std::size_t... Is>
+  std::tuple<Xs...> args_of_(const node** p_args,
+                             const std14::index_sequence<Is...>&)
+  {
+    return std::tuple<Xs...>(extract_node_value<Xs>(p_args[Is])...);
+  }
+
+  template <std::size_t... Is>
+  static T calculate_(Policy& policy,
+                      const std::tuple<Xs...>& args,
+                      const std14::index_sequence<Is...>&)
+  {
+    return policy.calculate(std::get<Is>(args)...);
+  }
+
+  void submit_(node_id id)
+  {
+    const auto generation = ++p_token_->generation;
+
+    run_node_async(
+      [id,
+       p_token = std::weak_ptr<const token>(p_token_),
+       generation,
+       policy = static_cast<const Policy&>(*this),
+       args = args_]() mutable -> std::unique_ptr<posted_input> {
+        if (is_stale(p_token, generation))
+          return nullptr;
+
+        return std::unique_ptr<posted_input>(new result(
+          id,
+          p_token,
+          generation,
+          calculate_(
+            policy, args, std14::make_index_sequence<sizeof...(Xs)>())));
+      });
+  }
+
+  void publish_(T value) const
+  {
+    pending_ = std::move(value);
+    has_pending_ = true;
+  }
+
+  virtual update_status update_(node_id id,
+                                bool initialized,
+                                const node** p_args,
+                                std::size_t args_count) override
+  {
+    DATAFLOW___CHECK_PRECONDITION(p_args != nullptr);
+    DATAFLOW___CHECK_PRECONDITION(args_count == sizeof...(Xs));
+
+    const auto is = std14::make_index_sequence<sizeof...(Xs)>();
+
+    auto status = update_status::nothing;
+
+    if (has_pending_)
+    {
+      has_pending_ = false;
+      status = this->set_value_(std::move(pending_));
+    }
+
+    if (!initialized || !same_args_(p_args, is))
+    {
+      args_ = args_of_(p_args, is);
+
+      submit_(id);
+    }
+
+    return status;
+  }
+
+  virtual void deactivate_(node_id id) override
+  {
+    ++p_token_->generation;
+    has_pending_ = false;
+
+    node_t<T>::perform_deactivation_();
+  }
+
+  virtual std::string label_() const override
+  {
+    return Policy::label();
+  }
+
+  virtual std::pair<std::size_t, std::size_t> mem_info_() const override final
+  {
+    return std::make_pair(sizeof(*this), alignof(decltype(*this)));
+  }
+
+private:
+  const std::shared_ptr<token> p_token_;
+  std::tuple<Xs...> args_;
+  mutable T pending_;
+  mutable bool has_pending_;
+};
+} // internal
+} // dataflow
@@ -23,6 +23,8 @@
 #include "nodes_factory.h"
 #include "ref.h"
 
+#include <functional>
+#include <type_traits>
 #include <utility>
 
 namespace dataflow
@@ -36,10 +38,21 @@ template <typename T> class node_const final : public node_t<T>
 public:
   static ref create(const T& v)
   {
-    return nodes_factory::create_constant<node_const<T>>(v);
+    return create_(v, std::integral_constant<bool, is_hashable<T>::value>());
   }
 
 private:
+  static ref create_(const T& v, const std::true_type& /*hashable*/)
+  {
+    return nodes_factory::create_interned_constant<node_const<T>>(
+      v, std::hash<T>()(v));
+  }
+
+  static ref create_(const T& v, const std::false_type& /*hashable*/)
+  {
+    return nodes_factory::create_constant<node_const<T>>(v);
+  }
+
   explicit node_const(const T& v)
   : node_t<T>(v)
   {
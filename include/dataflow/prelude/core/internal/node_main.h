@@ -43,7 +43,7 @@ public:
     const auto id = x.id();
 
     const ref y = nodes_factory::create<node_main<T>>(
-      &id, 1, node_flags::eager | node_flags::pump);
+      &id, 1, node_flags::eager | node_flags::pump | node_flags::concurrent);
 
     return y;
   }
@@ -0,0 +1,200 @@
+
+//  Copyright (c) 2014 - 2020 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "config.h"
+#include "node_t.h"
+#include "nodes_factory.h"
+#include "ref.h"
+
+#include <dataflow/utility/std_future.h>
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace dataflow
+{
+namespace internal
+{
+namespace detail
+{
+template <typename T>
+std::size_t memo_hash(const T& v, const std::true_type& /*hashable*/)
+{
+  return std::hash<T>()(v);
+}
+
+template <typename T>
+std::size_t memo_hash(const T&, const std::false_type& /*hashable*/)
+{
+  return 0;
+}
+
+inline std::size_t memo_hash_combine(std::size_t seed, std::size_t hash)
+{
+  return seed ^ (hash + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+}
+
+/// Same as `node_n_ary`, but keeps the most recently calculated results in a
+/// small cache, so that the policy is not called again for the arguments that
+/// it has already seen. Arguments without `std::hash` only take part in the
+/// cache lookup through the equality comparison.
+template <typename Policy, typename T, typename... Xs>
+class node_memo_n_ary final : public node_t<T>, public Policy
+{
+  friend class nodes_factory;
+
+private:
+  static constexpr std::size_t capacity = 8;
+
+  struct entry
+  {
+    std::size_t hash;
+    std::tuple<Xs...> args;
+    T value;
+  };
+
+public:
+  static ref create(Policy policy, ref_t<Xs>... xs)
+  {
+    DATAFLOW___CHECK_PRECONDITION(
+      check_all_of(xs.template is_of_type<Xs>()...));
+
+    const std::array<node_id, sizeof...(Xs)> args = {{xs.id()...}};
+
+    const auto flags =
+      (allows_concurrent_update<Policy>() ? node_flags::concurrent
+                                          : node_flags::none) |
+      (allows_retention<Policy>() ? node_flags::retainable : node_flags::none);
+
+    return nodes_factory::create<node_memo_n_ary<Policy, T, Xs...>>(
+      &args[0], args.size(), flags, std::move(policy));
+  }
+
+private:
+  explicit node_memo_n_ary(Policy policy)
+  : Policy(std::move(policy))
+  , cache_()
+  {
+  }
+
+  template <std::size_t... Is>
+  static std::size_t hash_(const node** p_args,
+                           const std14::index_sequence<Is...>&)
+  {
+    const std::size_t hashes[] = {detail::memo_hash(
+      extract_node_value<Xs>(p_args[Is]),
+      std::integral_constant<bool, is_hashable<Xs>::value>())...};
+
+    return std::accumulate(std::begin(hashes),
+                           std::end(hashes),
+                           std::size_t(0),
+                           &detail::memo_hash_combine);
+  }
+
+  template <std::size_t... Is>
+  static bool matches_(const entry& e,
+                       std::size_t hash,
+                       const node** p_args,
+                       const std14::index_sequence<Is...>&)
+  {
+    return e.hash == hash &&
+           check_all_of(is_same_value(std::get<Is>(e.args),
+                                      extract_node_value<Xs>(p_args[Is]))...);
+  }
+
+  template <std::size_t... Is>
+  T calculate_(const node** p_args, const std14::index_sequence<Is...>&)
+  {
+    return Policy::calculate(extract_node_value<Xs>(p_args[Is])...);
+  }
+
+  template <std::size_t... Is>
+  std::tuple<Xs...> args_(const node** p_args,
+                          const std14::index_sequence<Is...>&)
+  {
+    return std::tuple<Xs...>(extract_node_value<Xs>(p_args[Is])...);
+  }
+
+  virtual update_status update_(node_id id,
+                                bool initialized,
+                                const node** p_args,
+                                std::size_t args_count) override
+  {
+    DATAFLOW___CHECK_PRECONDITION(p_args != nullptr);
+    DATAFLOW___CHECK_PRECONDITION(args_count == sizeof...(Xs));
+
+    const auto is = std14::make_index_sequence<sizeof...(Xs)>();
+    const auto hash = hash_(p_args, is);
+
+    const auto it =
+      std::find_if(cache_.begin(), cache_.end(), [&](const entry& e) {
+        return matches_(e, hash, p_args, is);
+      });
+
+    // The cache is kept in the most recently used first order
+    if (it != cache_.end())
+    {
+      std::rotate(cache_.begin(), it, std::next(it));
+    }
+    else
+    {
+      if (cache_.size() == capacity)
+        cache_.pop_back();
+
+      cache_.insert(cache_.begin(),
+                    entry{hash, args_(p_args, is), calculate_(p_args, is)});
+    }
+
+    return this->set_value_(cache_.front().value);
+  }
+
+  // A retained node isn't deactivated, and so keeps its cache as well
+  virtual void deactivate_(node_id id) override
+  {
+    std::vector<entry>().swap(cache_);
+
+    node_t<T>::perform_deactivation_();
+  }
+
+  virtual std::string label_() const override
+  {
+    return Policy::label();
+  }
+
+  virtual std::pair<std::size_t, std::size_t> mem_info_() const override final
+  {
+    return std::make_pair(sizeof(*this), alignof(decltype(*this)));
+  }
+
+private:
+  std::vector<entry> cache_;
+};
+
+template <typename Policy, typename T, typename... Xs>
+constexpr std::size_t node_memo_n_ary<Policy, T, Xs...>::capacity;
+} // internal
+} // dataflow
@@ -19,6 +19,7 @@
 #pragma once
 
 #include "config.h"
+#include "node_const.h"
 #include "node_t.h"
 #include "nodes_factory.h"
 #include "ref.h"
@@ -26,6 +27,7 @@
 #include <dataflow/utility/std_future.h>
 
 #include <array>
+#include <type_traits>
 #include <utility>
 
 namespace dataflow
@@ -44,13 +46,34 @@ public:
     DATAFLOW___CHECK_PRECONDITION(
       check_all_of(xs.template is_of_type<Xs>()...));
 
+    // The value of a pure function of constants never changes, and so the
+    // node would be updated only once
+    if (!eager && allows_concurrent_update<Policy>() &&
+        check_all_of(nodes_factory::is_foldable_constant(xs)...))
+    {
+      return node_const<T>::create(
+        policy.calculate(xs.template value<Xs>()...));
+    }
+
     const std::array<node_id, sizeof...(Xs)> args = {{xs.id()...}};
 
+    const auto flags =
+      (eager ? node_flags::eager : node_flags::none) |
+      (allows_concurrent_update<Policy>() ? node_flags::concurrent
+                                          : node_flags::none) |
+      (allows_retention<Policy>() ? node_flags::retainable : node_flags::none);
+
+    // A stateless policy computes the same value from the same arguments, so
+    // such nodes can be shared
+    if (!eager && std::is_empty<Policy>::value &&
+        allows_concurrent_update<Policy>())
+    {
+      return nodes_factory::create_interned<node_n_ary<Policy, T, Xs...>>(
+        &args[0], args.size(), flags, std::move(policy));
+    }
+
     return nodes_factory::create<node_n_ary<Policy, T, Xs...>>(
-      &args[0],
-      args.size(),
-      eager ? node_flags::eager : node_flags::none,
-      std::move(policy));
+      &args[0], args.size(), flags, std::move(policy));
   }
 
 private:
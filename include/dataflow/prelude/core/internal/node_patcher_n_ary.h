@@ -83,7 +83,7 @@ private:
   template <typename Diff, std::size_t Idx>
   Diff get_argument_diff_(const node* p_node)
   {
-    const auto& p_metadata = node::get_metadata(p_node).get();
+    const auto p_metadata = node::get_metadata(p_node);
 
     const auto& curr = extract_node_value<typename Diff::data_type>(p_node);
     const auto& prev = std::get<Idx>(prev_args_);
@@ -114,13 +114,12 @@ private:
       prev_args_ = std::tuple<typename InDiffs::data_type...>{
         extract_node_value<typename InDiffs::data_type>(p_args[Is])...};
 
-      node::set_metadata(this,
-                         std::unique_ptr<patch_metadata<OutPatch>>{
-                           new patch_metadata<OutPatch>{patch}});
+      if (is_empty_patch(patch))
+        return update_status::nothing;
 
-      const auto v = patch.apply(this->value());
+      node::emplace_metadata<patch_metadata<OutPatch>>(this, patch);
 
-      return this->set_value_(v);
+      return this->set_value_(patch.apply(this->value()));
     }
 
     return this->set_value_(initialize_<typename InDiffs::data_type...>(
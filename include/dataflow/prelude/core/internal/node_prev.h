@@ -0,0 +1,115 @@
+
+//  Copyright (c) 2014 - 2020 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include "config.h"
+#include "node_t.h"
+#include "nodes_factory.h"
+#include "ref.h"
+
+#include <utility>
+
+namespace dataflow
+{
+namespace internal
+{
+/// Node calculating its value from the current value of `x` and the value `x`
+/// had at the previous tick (`v0` at the initial one). When `x` changes, the
+/// node updates itself once more at the next tick to catch up with it.
+///
+/// The node is eager, so it keeps its state from the tick it is created at
+/// rather than starting over whenever its consumers get reactivated.
+template <typename Policy, typename T, typename X>
+class node_prev final : public node_t<T>, public Policy
+{
+  friend class nodes_factory;
+
+public:
+  static ref create(Policy policy, const ref& x, const X& v0)
+  {
+    DATAFLOW___CHECK_PRECONDITION(x.template is_of_type<X>());
+
+    const auto id = x.id();
+
+    return nodes_factory::create<node_prev<Policy, T, X>>(
+      &id, 1, node_flags::eager, std::move(policy), true, v0);
+  }
+
+  static ref create(Policy policy, const ref& x)
+  {
+    DATAFLOW___CHECK_PRECONDITION(x.template is_of_type<X>());
+
+    const auto id = x.id();
+
+    return nodes_factory::create<node_prev<Policy, T, X>>(
+      &id, 1, node_flags::eager, std::move(policy), false, X());
+  }
+
+private:
+  explicit node_prev(Policy policy, bool has_v0, const X& v0)
+  : Policy(std::move(policy))
+  , has_v0_(has_v0)
+  , v0_(v0)
+  , last_(v0)
+  {
+  }
+
+  virtual update_status update_(node_id id,
+                                bool initialized,
+                                const node** p_args,
+                                std::size_t args_count) override
+  {
+    DATAFLOW___CHECK_PRECONDITION(p_args != nullptr);
+    DATAFLOW___CHECK_PRECONDITION(args_count == 1);
+
+    const auto& x = extract_node_value<X>(p_args[0]);
+
+    // `x` hasn't changed since the latest update, so `last_` is its value at
+    // the previous tick
+    if (!initialized)
+      last_ = has_v0_ ? v0_ : x;
+
+    auto status = this->set_value_(Policy::calculate(x, last_));
+
+    // The initial value is always followed by an update at the next tick, the
+    // same way as for `Recursion()`
+    if (!initialized || !(x == last_))
+      status |= update_status::updated_next;
+
+    last_ = x;
+
+    return status;
+  }
+
+  virtual std::string label_() const override
+  {
+    return Policy::label();
+  }
+
+  virtual std::pair<std::size_t, std::size_t> mem_info_() const override final
+  {
+    return std::make_pair(sizeof(*this), alignof(decltype(*this)));
+  }
+
+private:
+  const bool has_v0_;
+  const X v0_;
+  X last_;
+};
+} // internal
+} // dataflow
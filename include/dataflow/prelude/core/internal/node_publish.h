@@ -0,0 +1,92 @@
+
+//  Copyright (c) 2014 - 2021 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "config.h"
+#include "node_t.h"
+#include "nodes_factory.h"
+#include "published_slot.h"
+#include "ref.h"
+
+#include <memory>
+#include <utility>
+
+namespace dataflow
+{
+namespace internal
+{
+/// Same as `node_main`, but also copies every new value of its argument into
+/// a slot that other threads can read.
+template <typename T> class node_publish final : public node_t<T>
+{
+  friend class nodes_factory;
+
+public:
+  static ref create(const ref& x)
+  {
+    DATAFLOW___CHECK_PRECONDITION(x.template is_of_type<T>());
+
+    const auto id = x.id();
+
+    return nodes_factory::create<node_publish<T>>(
+      &id, 1, node_flags::eager | node_flags::pump | node_flags::concurrent);
+  }
+
+  std::shared_ptr<const published_slot<T>> slot() const
+  {
+    return p_slot_;
+  }
+
+private:
+  explicit node_publish()
+  : p_slot_(std::make_shared<published_slot<T>>(T()))
+  {
+  }
+
+  virtual update_status update_(node_id id,
+                                bool initialized,
+                                const node** p_args,
+                                std::size_t args_count) override
+  {
+    DATAFLOW___CHECK_PRECONDITION(p_args != nullptr);
+    DATAFLOW___CHECK_PRECONDITION(args_count == 1);
+
+    const auto status = this->set_value_(extract_node_value<T>(p_args[0]));
+
+    if (!initialized || status != update_status::nothing)
+      p_slot_->store(this->value());
+
+    return status;
+  }
+
+  virtual std::string label_() const override
+  {
+    return "publish";
+  }
+
+  virtual std::pair<std::size_t, std::size_t> mem_info_() const override final
+  {
+    return std::make_pair(sizeof(*this), alignof(decltype(*this)));
+  }
+
+private:
+  const std::shared_ptr<published_slot<T>> p_slot_;
+};
+} // internal
+} // dataflow
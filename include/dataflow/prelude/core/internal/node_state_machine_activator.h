@@ -0,0 +1,69 @@
+
+//  Copyright (c) 2014 - 2020 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "dataflow++_export.h"
+
+#include "node_t.h"
+#include "ref.h"
+
+#include <vector>
+
+namespace dataflow
+{
+namespace internal
+{
+/// Keeps the index of the current state of a state machine: 0 for the initial
+/// one and `i + 1` after the `i`-th transition has been taken. A transition is
+/// taken when its condition becomes the first satisfied one. Taking it again
+/// restarts the target state if the latter is `restartable`.
+///
+/// The conditions are checked from the tick following the initial one, the
+/// same way as for `Recursion()`.
+class DATAFLOW___EXPORT node_state_machine_activator final
+  : public node_t<std::size_t>
+{
+  friend class nodes_factory;
+
+public:
+  static ref create(const ref* p_conditions,
+                    std::size_t conditions_count,
+                    std::vector<bool> restartable);
+
+private:
+  explicit node_state_machine_activator(std::vector<bool> restartable);
+
+  virtual update_status update_(node_id id,
+                                bool initialized,
+                                const node** p_args,
+                                std::size_t args_count) override;
+
+  virtual std::string label_() const override;
+
+  virtual std::pair<std::size_t, std::size_t> mem_info_() const override final
+  {
+    return std::make_pair(sizeof(*this), alignof(decltype(*this)));
+  }
+
+private:
+  const std::vector<bool> restartable_;
+  std::size_t selected_;
+};
+} // internal
+} // dataflow
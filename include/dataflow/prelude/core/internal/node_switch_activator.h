@@ -0,0 +1,107 @@
+
+//  Copyright (c) 2014 - 2020 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include "dataflow++_export.h"
+
+#include "node_t.h"
+#include "nodes_factory.h"
+#include "ref.h"
+
+#include <vector>
+
+namespace dataflow
+{
+namespace internal
+{
+DATAFLOW___EXPORT update_status
+update_node_switch_activator(node_id id,
+                             bool initialized,
+                             std::size_t new_alternative,
+                             std::size_t old_alternative);
+
+/// Finds the first key equal to the selector and activates the alternative
+/// with the same index (the last alternative if there is no such key).
+template <typename T>
+class node_switch_activator final : public node_t<std::size_t>
+{
+  friend class nodes_factory;
+
+public:
+  static ref create(const ref& x, const ref* p_keys, std::size_t keys_count)
+  {
+    DATAFLOW___CHECK_PRECONDITION(x.template is_of_type<T>());
+    DATAFLOW___CHECK_PRECONDITION(p_keys != nullptr || keys_count == 0);
+
+    std::vector<node_id> args;
+
+    args.reserve(1 + keys_count);
+    args.push_back(x.id());
+
+    for (std::size_t i = 0; i < keys_count; ++i)
+    {
+      DATAFLOW___CHECK_PRECONDITION(p_keys[i].template is_of_type<T>());
+
+      args.push_back(p_keys[i].id());
+    }
+
+    return nodes_factory::create<node_switch_activator<T>>(
+      args.data(), args.size(), node_flags::none);
+  }
+
+private:
+  explicit node_switch_activator()
+  : node_t<std::size_t>(0)
+  {
+  }
+
+  virtual update_status update_(node_id id,
+                                bool initialized,
+                                const node** p_args,
+                                std::size_t args_count) override
+  {
+    DATAFLOW___CHECK_PRECONDITION(p_args != nullptr && args_count >= 1);
+
+    const auto& x = extract_node_value<T>(p_args[0]);
+
+    std::size_t new_value = 0;
+
+    while (new_value + 1 < args_count &&
+           !(extract_node_value<T>(p_args[new_value + 1]) == x))
+    {
+      ++new_value;
+    }
+
+    const auto result = update_node_switch_activator(
+      id, initialized, new_value, this->value());
+
+    return this->set_value_(new_value) | result;
+  }
+
+  virtual std::string label_() const override
+  {
+    return "switch-activator";
+  }
+
+  virtual std::pair<std::size_t, std::size_t> mem_info_() const override final
+  {
+    return std::make_pair(sizeof(*this), alignof(decltype(*this)));
+  }
+};
+} // internal
+} // dataflow
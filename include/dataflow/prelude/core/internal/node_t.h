@@ -24,6 +24,7 @@
 
 #include <algorithm>
 #include <sstream>
+#include <utility>
 
 namespace dataflow
 {
@@ -97,7 +98,7 @@ protected:
 
   update_status set_value_(const T& v)
   {
-    if (value_ == v)
+    if (is_same_value(value_, v))
       return update_status::nothing;
 
     value_ = v;
@@ -105,6 +106,23 @@ protected:
     return update_status::updated;
   }
 
+  update_status set_value_(T&& v)
+  {
+    if (is_same_value(value_, v))
+      return update_status::nothing;
+
+    value_ = std::move(v);
+
+    return update_status::updated;
+  }
+
+  void swap_value_(T& v)
+  {
+    using std::swap;
+
+    swap(value_, v);
+  }
+
   void perform_deactivation_()
   {
     value_ = T{};
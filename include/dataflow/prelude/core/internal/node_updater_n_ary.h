@@ -46,11 +46,15 @@ public:
 
     const std::array<node_id, sizeof...(Xs)> args = {{xs.id()...}};
 
+    // The value is accumulated state, which must start over after
+    // reactivation, so it is never retained
+    const auto flags = (eager ? node_flags::eager : node_flags::none) |
+                       (allows_concurrent_update<Policy>()
+                          ? node_flags::concurrent
+                          : node_flags::none);
+
     return nodes_factory::create<node_updater_n_ary<Policy, T, Xs...>>(
-      &args[0],
-      args.size(),
-      eager ? node_flags::eager : node_flags::none,
-      std::move(policy));
+      &args[0], args.size(), flags, std::move(policy));
   }
 
 private:
@@ -81,14 +85,14 @@ private:
     DATAFLOW___CHECK_PRECONDITION(p_args != nullptr);
     DATAFLOW___CHECK_PRECONDITION(args_count == sizeof...(Xs));
 
-    const auto new_value =
+    auto new_value =
       initialized
         ? update_<Xs...>(
             this->value(), p_args, std14::make_index_sequence<sizeof...(Xs)>())
         : calculate_<Xs...>(p_args,
                             std14::make_index_sequence<sizeof...(Xs)>());
 
-    return this->set_value_(new_value);
+    return this->set_value_(std::move(new_value));
   }
 
   virtual std::string label_() const override
@@ -34,39 +34,85 @@ template <typename T> class node_var final : public node_t<T>
   friend class nodes_factory;
 
 public:
-  static ref create(const T& v)
+  static ref create(T v)
   {
-    return nodes_factory::create<node_var<T>>(nullptr, 0, node_flags::none, v);
+    return nodes_factory::create<node_var<T>>(
+      nullptr,
+      0,
+      node_flags::concurrent | node_flags::retainable,
+      std::move(v));
   }
 
   bool set_next_value(const T& v) const
   {
-    if (next_value_ == v)
+    if (is_same_value(next_value(), v))
       return false;
 
     next_value_ = v;
+    pending_ = true;
+
+    return true;
+  }
+
+  bool set_next_value(T&& v) const
+  {
+    if (is_same_value(next_value(), v))
+      return false;
+
+    next_value_ = std::move(v);
+    pending_ = true;
 
     return true;
   }
 
   const T& next_value() const
   {
-    return next_value_;
+    return pending_ ? next_value_ : this->value();
+  }
+
+  // Returns `true` if the next value hasn't been published yet
+  bool has_pending_value() const
+  {
+    return pending_;
   }
 
 private:
-  explicit node_var(const T& v)
+  explicit node_var(T v)
   : node_t<T>(T{})
-  , next_value_(v)
+  , next_value_(std::move(v))
+  , pending_(true)
   {
   }
 
+  // The next value is published by swapping it with the current one, after
+  // that `next_value_` only keeps its storage around for the next assignment.
   virtual update_status update_(node_id id,
                                 bool initialized,
                                 const node** p_args,
                                 std::size_t args_count) override
   {
-    return this->set_value_(next_value_);
+    if (!pending_)
+      return update_status::nothing;
+
+    pending_ = false;
+
+    if (is_same_value(this->value(), next_value_))
+      return update_status::nothing;
+
+    this->swap_value_(next_value_);
+
+    return update_status::updated;
+  }
+
+  virtual void deactivate_(node_id id) override
+  {
+    if (!pending_)
+    {
+      this->swap_value_(next_value_);
+      pending_ = true;
+    }
+
+    node_t<T>::perform_deactivation_();
   }
 
   virtual std::string label_() const override
@@ -81,6 +127,7 @@ private:
 
 private:
   mutable T next_value_;
+  mutable bool pending_;
 };
 } // internal
 } // dataflow
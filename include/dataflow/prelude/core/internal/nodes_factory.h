@@ -22,9 +22,11 @@
 
 #include "ref.h"
 
-#include <cstddef> // std::size_t
-#include <memory>  // std::addressof
-#include <utility> // std::forward
+#include <cmath>       // std::signbit
+#include <cstddef>     // std::size_t
+#include <memory>      // std::addressof
+#include <type_traits> // std::is_floating_point
+#include <utility>     // std::forward
 
 namespace dataflow
 {
@@ -36,7 +38,9 @@ enum class node_flags
 {
   none = 0x00,
   eager = 0x01,
-  pump = 0x02
+  pump = 0x02,
+  concurrent = 0x04,
+  retainable = 0x08
 };
 
 inline node_flags operator|(node_flags lhs, node_flags rhs)
@@ -74,8 +78,34 @@ public:
                     node_flags flags,
                     Args&&... args)
   {
-    return add_(
-      new_node_<Node>(std::forward<Args>(args)...), p_args, args_count, flags);
+    return add_(new_node_<Node>(std::forward<Args>(args)...),
+                &update_<Node>,
+                p_args,
+                args_count,
+                flags);
+  }
+
+  /// Same as `create()`, but returns the existing node of the same type with
+  /// the same arguments if hash-consing is enabled. Nodes created this way
+  /// must have no state other than their value.
+  template <typename Node, typename... Args>
+  static ref create_interned(const node_id* p_args,
+                             std::size_t args_count,
+                             node_flags flags,
+                             Args&&... args)
+  {
+    node_id id;
+
+    if (find_interned_(
+          &update_<Node>, 0, p_args, args_count, nullptr, nullptr, id))
+      return ref(id);
+
+    auto x =
+      create<Node>(p_args, args_count, flags, std::forward<Args>(args)...);
+
+    intern_(x.id(), &update_<Node>, 0, p_args, args_count);
+
+    return x;
   }
 
   template <typename Node, typename... Args>
@@ -84,8 +114,11 @@ public:
                                 node_flags flags,
                                 Args&&... args)
   {
-    return add_conditional_(
-      new_node_<Node>(std::forward<Args>(args)...), p_args, args_count, flags);
+    return add_conditional_(new_node_<Node>(std::forward<Args>(args)...),
+                            &update_<Node>,
+                            p_args,
+                            args_count,
+                            flags);
   }
 
   template <typename Node, typename... Args>
@@ -94,11 +127,35 @@ public:
     return add_constant_(new_node_<Node>(std::forward<Args>(args)...));
   }
 
+  /// Same as `create_constant()`, but returns the existing constant with the
+  /// same value if hash-consing is enabled.
+  template <typename Node, typename T>
+  static ref create_interned_constant(const T& v, std::size_t hash)
+  {
+    node_id id;
+
+    if (find_interned_(
+          &update_<Node>, hash, nullptr, 0, &equal_<Node, T>, &v, id))
+      return ref(id);
+
+    auto x = create_constant<Node>(v);
+
+    intern_(x.id(), &update_<Node>, hash, nullptr, 0);
+
+    return x;
+  }
+
   static ref get_time()
   {
     return get_time_();
   }
 
+  /// Checks whether `x` is a constant which lifted nodes may be folded over.
+  static bool is_foldable_constant(const ref& x);
+
+  /// Checks whether the value of `x` is known and never changes.
+  static bool is_constant(const ref& x);
+
 private:
   template <typename Node, typename... Args>
   static Node* new_node_(Args&&... args)
@@ -119,18 +176,76 @@ private:
     return p_node;
   }
 
+  // Calls `Node::update_()` directly, so that the pump doesn't go through the
+  // virtual table for the nodes created by the factory.
+  template <typename Node>
+  static update_status update_(node* p_node,
+                               node_id id,
+                               bool initialized,
+                               const node** p_args,
+                               std::size_t args_count)
+  {
+    DATAFLOW___CHECK_PRECONDITION_DEBUG(dynamic_cast<Node*>(p_node));
+    DATAFLOW___CHECK_PRECONDITION_DEBUG(p_node->activation_count_ ==
+                                        p_node->deactivation_count_ + 1);
+
+    return static_cast<Node*>(p_node)->Node::update_(
+      id, initialized, p_args, args_count);
+  }
+
+  using equal_function = bool (*)(const node* p_node, const void* p_value);
+
+  template <typename Node, typename T>
+  static bool equal_(const node* p_node, const void* p_value)
+  {
+    DATAFLOW___CHECK_PRECONDITION_DEBUG(dynamic_cast<const Node*>(p_node));
+
+    return same_constant_(
+      static_cast<const Node*>(p_node)->value(),
+      *static_cast<const T*>(p_value),
+      std::integral_constant<bool, std::is_floating_point<T>::value>());
+  }
+
+  template <typename T>
+  static bool same_constant_(const T& a, const T& b, const std::false_type&)
+  {
+    return a == b;
+  }
+
+  // Zeros of different signs are equal, but `1.0 / x` tells them apart
+  template <typename T>
+  static bool
+  same_constant_(const T& a, const T& b, const std::true_type& /*floating*/)
+  {
+    return a == b && std::signbit(a) == std::signbit(b);
+  }
+
   static void* allocate_(std::size_t size, std::size_t allignment);
   static void deallocate_(void*, std::size_t size, std::size_t alignment);
 
   static ref add_(node* p_node,
+                  update_function p_update,
                   const node_id* p_args,
                   std::size_t args_count,
                   node_flags flags);
   static ref add_conditional_(node* p_node,
+                              update_function p_update,
                               const node_id* p_args,
                               std::size_t args_count,
                               node_flags flags);
   static ref add_constant_(node* p_node);
+  static bool find_interned_(update_function p_type,
+                             std::size_t hash,
+                             const node_id* p_args,
+                             std::size_t args_count,
+                             equal_function p_equal,
+                             const void* p_value,
+                             node_id& id);
+  static void intern_(node_id id,
+                      update_function p_type,
+                      std::size_t hash,
+                      const node_id* p_args,
+                      std::size_t args_count);
   static ref get_time_();
 };
 }
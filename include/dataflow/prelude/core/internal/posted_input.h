@@ -0,0 +1,132 @@
+
+//  Copyright (c) 2014 - 2021 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "dataflow++_export.h"
+
+#include "config.h"
+#include "node_var.h"
+
+#include <utility>
+
+namespace dataflow
+{
+namespace internal
+{
+DATAFLOW___EXPORT void forget_posted_metadata(const node* p_node);
+
+/// Input posted to an engine from another thread, to be applied to the node
+/// `id` by the engine thread.
+class posted_input
+{
+public:
+  explicit posted_input(node_id id)
+  : p_next(nullptr)
+  , id_(id)
+  {
+  }
+
+  virtual ~posted_input() = default;
+
+  posted_input(const posted_input&) = delete;
+  posted_input& operator=(const posted_input&) = delete;
+
+  node_id id() const
+  {
+    return id_;
+  }
+
+  /// Returns `true` if the input is not wanted anymore. Expired inputs are
+  /// dropped without looking their nodes up, which might not exist by then.
+  virtual bool expired() const
+  {
+    return false;
+  }
+
+  /// Returns `true` if a later input for the same node makes this one
+  /// redundant.
+  virtual bool conflatable() const = 0;
+
+  /// Returns `true` if the node has to be updated.
+  virtual bool apply(const node* p_node) = 0;
+
+public:
+  posted_input* p_next;
+
+private:
+  const node_id id_;
+};
+
+template <typename T> class posted_value final : public posted_input
+{
+public:
+  explicit posted_value(node_id id, T value)
+  : posted_input(id)
+  , value_(std::move(value))
+  {
+  }
+
+  virtual bool conflatable() const override
+  {
+    return true;
+  }
+
+  virtual bool apply(const node* p_node) override
+  {
+    DATAFLOW___CHECK_PRECONDITION(
+      dynamic_cast<const node_var<T>*>(p_node) != nullptr);
+
+    const auto p_var = static_cast<const node_var<T>*>(p_node);
+    const bool pending = p_var->has_pending_value();
+
+    if (!p_var->set_next_value(std::move(value_)))
+      return false;
+
+    // Drops the patch of an earlier change that hasn't been published yet,
+    // just like an assignment does
+    if (pending)
+      forget_posted_metadata(p_node);
+
+    return true;
+  }
+
+private:
+  T value_;
+};
+
+class posted_signal final : public posted_input
+{
+public:
+  explicit posted_signal(node_id id)
+  : posted_input(id)
+  {
+  }
+
+  virtual bool conflatable() const override
+  {
+    return false;
+  }
+
+  virtual bool apply(const node*) override
+  {
+    return true;
+  }
+};
+} // internal
+} // dataflow
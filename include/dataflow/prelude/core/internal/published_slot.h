@@ -0,0 +1,126 @@
+
+//  Copyright (c) 2014 - 2021 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+namespace dataflow
+{
+namespace internal
+{
+/// Value written by the engine thread and read by any number of other
+/// threads, following the Left-Right algorithm (Ramalhete and Correia).
+///
+/// There are two instances of the value. Readers copy the one that is not
+/// being written, announcing themselves in one of two read indicators, which
+/// makes reading wait-free. The writer updates the other instance, switches
+/// the readers to it and waits until the readers of the previous instance
+/// leave. Only then is the previous instance overwritten, so no value is ever
+/// read while it is being written, and nothing has to be reclaimed later.
+template <typename T> class published_slot final
+{
+public:
+  explicit published_slot(const T& v)
+  : instances_{v, v}
+  , left_right_(0)
+  , version_index_(0)
+  , version_(0)
+  {
+    read_indicators_[0].store(0);
+    read_indicators_[1].store(0);
+  }
+
+  published_slot(const published_slot&) = delete;
+  published_slot& operator=(const published_slot&) = delete;
+
+  T load() const
+  {
+    const reader_guard guard(read_indicators_[version_index_.load()]);
+
+    return instances_[left_right_.load()];
+  }
+
+  std::size_t version() const
+  {
+    return version_.load();
+  }
+
+  /// Must be called from a single thread at a time.
+  void store(const T& v)
+  {
+    const auto lr = left_right_.load(std::memory_order_relaxed);
+
+    instances_[1 - lr] = v;
+
+    left_right_.store(1 - lr);
+
+    const auto prev_vi = version_index_.load(std::memory_order_relaxed);
+    const auto next_vi = 1 - prev_vi;
+
+    wait_for_readers_(next_vi);
+
+    version_index_.store(next_vi);
+
+    wait_for_readers_(prev_vi);
+
+    instances_[lr] = v;
+
+    ++version_;
+  }
+
+private:
+  class reader_guard final
+  {
+  public:
+    explicit reader_guard(std::atomic<std::size_t>& indicator)
+    : indicator_(indicator)
+    {
+      indicator_.fetch_add(1);
+    }
+
+    ~reader_guard()
+    {
+      indicator_.fetch_sub(1);
+    }
+
+    reader_guard(const reader_guard&) = delete;
+    reader_guard& operator=(const reader_guard&) = delete;
+
+  private:
+    std::atomic<std::size_t>& indicator_;
+  };
+
+  void wait_for_readers_(std::size_t vi) const
+  {
+    // Readers only copy the value, so they don't keep the writer for long
+    while (read_indicators_[vi].load() != 0)
+      std::this_thread::yield();
+  }
+
+private:
+  T instances_[2];
+  std::atomic<std::size_t> left_right_;
+  std::atomic<std::size_t> version_index_;
+  mutable std::atomic<std::size_t> read_indicators_[2];
+  std::atomic<std::size_t> version_;
+};
+} // internal
+} // dataflow
@@ -53,13 +53,21 @@ protected:
 
   void schedule_() const;
 
-  void set_metadata(std::shared_ptr<const metadata> p_metadata);
+  template <typename Metadata, typename... Args>
+  void emplace_metadata(Args&&... args);
+
+  // Drops the metadata emplaced during the current update, if any
+  void reset_metadata_() const;
 
   void reset_(const ref& other);
 
 private:
   explicit ref(node_id id);
 
+  // Returns `nullptr` if the node is not active
+  void* allocate_metadata_(std::size_t size, std::size_t alignment) const;
+  void set_metadata_(const metadata* p_metadata) const;
+
 private:
   ref& operator=(const ref&) = delete;
 
@@ -84,6 +92,13 @@ template <typename T> const T& ref::value() const
   return static_cast<const node_t<T>*>(get_())->value();
 }
 
+template <typename Metadata, typename... Args>
+void ref::emplace_metadata(Args&&... args)
+{
+  if (const auto p = allocate_metadata_(sizeof(Metadata), alignof(Metadata)))
+    set_metadata_(::new (p) Metadata(std::forward<Args>(args)...));
+}
+
 template <typename> using ref_t = ref;
 } // internal
 } // dataflow
@@ -20,6 +20,7 @@
 
 #include <dataflow/utility/std_future.h>
 
+#include <functional>
 #include <ostream>
 #include <type_traits>
 
@@ -61,6 +62,22 @@ public:
 
 template <typename T> constexpr const bool is_equality_comparable<T>::value;
 
+template <typename T> struct is_hashable
+{
+private:
+  template <typename U>
+  static std::is_convertible<decltype(std::hash<U>()(std::declval<const U&>())),
+                             std::size_t>
+  test_(int);
+
+  template <typename> static std::false_type test_(...);
+
+public:
+  static constexpr const bool value = decltype(test_<T>(0))::value;
+};
+
+template <typename T> constexpr const bool is_hashable<T>::value;
+
 template <typename T> struct is_callable
 {
 private:
@@ -75,5 +92,92 @@ public:
 
 template <typename T> constexpr const bool is_callable<T>::value;
 
+namespace detail
+{
+template <typename Policy>
+auto allows_concurrent_update(int)
+  -> decltype(static_cast<bool>(Policy::concurrent()))
+{
+  return Policy::concurrent();
+}
+
+template <typename Policy> bool allows_concurrent_update(...)
+{
+  return true;
+}
+
+template <typename Policy>
+auto allows_retention(int) -> decltype(static_cast<bool>(Policy::retainable()))
+{
+  return Policy::retainable();
+}
+
+template <typename Policy> bool allows_retention(...)
+{
+  return true;
+}
+
+template <typename T>
+auto is_same_value(const T& a, const T& b, int)
+  -> decltype(static_cast<bool>(a.identical(b)))
+{
+  return a.identical(b);
+}
+
+template <typename T> bool is_same_value(const T& a, const T& b, ...)
+{
+  return a == b;
+}
+
+template <typename Patch>
+auto is_empty_patch(const Patch& patch, int)
+  -> decltype(static_cast<bool>(patch.empty()))
+{
+  return patch.empty();
+}
+
+template <typename Patch> bool is_empty_patch(const Patch& patch, ...)
+{
+  return false;
+}
+}
+
+/// Checks whether nodes with the given policy can be updated concurrently with
+/// other nodes. Policies opt out by defining a static `concurrent()` function
+/// returning `false`.
+///
+template <typename Policy> bool allows_concurrent_update()
+{
+  return detail::allows_concurrent_update<Policy>(0);
+}
+
+/// Checks whether a deactivated node with the given policy can keep its value
+/// for reuse (see `engine_options::warm_deactivation`). Policies with side
+/// effects opt out by defining a static `retainable()` function returning
+/// `false`.
+///
+template <typename Policy> bool allows_retention()
+{
+  return detail::allows_retention<Policy>(0);
+}
+
+/// Checks whether a node changes its value from `a` to `b`. Types with an
+/// expensive `operator==` opt in to a cheaper check by defining a member
+/// function `bool identical(const T&) const`, which may take equal values for
+/// different ones, but never the other way round.
+///
+template <typename T> bool is_same_value(const T& a, const T& b)
+{
+  return detail::is_same_value(a, b, 0);
+}
+
+/// Checks whether the patch is known to leave values intact. Patches opt in by
+/// defining a member function `bool empty() const`.
+///
+template <typename Patch> bool is_empty_patch(const Patch& patch)
+{
+  return detail::is_empty_patch(patch, 0);
+}
+
 }
 }
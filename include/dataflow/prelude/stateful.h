@@ -69,6 +69,9 @@ std::pair<ref<core::enable_for_argument_data_type_t<ArgT, bool>>,
 On(const ArgT& x, const FArgU& y);
 
 /// Previous value
+///
+/// The value `x` had at the previous tick, `v0` at the initial one. If `v0`
+/// is a constant or `x` itself, it is a single node.
 /// \{
 template <typename ArgV0,
           typename ArgX,
@@ -100,6 +103,37 @@ template <typename ArgX,
 init_function<T> Diff(const ArgX& x);
 /// \}
 
+/// Fold over time
+///
+/// Starts with `f(init, x)` and applies `f(accumulator, x)` at every change
+/// of `x`. The accumulation restarts when the node gets activated again.
+///
+template <typename ArgX,
+          typename F,
+          typename T,
+          typename...,
+          typename X = core::argument_data_type_t<ArgX>,
+          typename U = core::convert_to_flowable_t<T>,
+          typename = core::enable_if_all_t<
+            void,
+            std::is_convertible<decltype(std::declval<F>()(
+                                  std::declval<const U&>(),
+                                  std::declval<const X&>())),
+                                U>>>
+ref<U> Accumulate(const ArgX& x, const F& f, const T& init);
+
+/// Sample and hold
+///
+/// Follows `x` while `trigger` is `true` and keeps the latest taken value
+/// while it is `false`. The initial value is taken regardless of `trigger`.
+///
+template <typename ArgX,
+          typename ArgTrigger,
+          typename...,
+          typename T = core::argument_data_type_t<ArgX>,
+          typename = core::enable_for_argument_data_type_t<ArgTrigger, bool>>
+ref<T> Hold(const ArgX& x, const ArgTrigger& trigger);
+
 /// \}
 } // dataflow
 
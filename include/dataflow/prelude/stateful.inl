@@ -20,12 +20,16 @@
 #error '.inl' file can't be included directly. Use 'stateful.h' instead
 #endif
 
+#include "core/internal/node_prev.h"
+#include "core/internal/node_state_machine_activator.h"
+#include "core/internal/node_switch.h"
 #include "stateful/internal/curr_prev.h"
-#include "stateful/internal/transition.h"
 
 #include "conditional.h"
 
+#include <array>
 #include <tuple>
+#include <vector>
 
 namespace dataflow
 {
@@ -54,75 +58,130 @@ public:
     decltype(test_(std::declval<const F*>(), std::declval<const T*>()));
 };
 
-template <typename T, typename... Trs, std::size_t... Is>
-ref<T> make_state_machine(
-  const std::tuple<Trs...>& transitions,
-  const std14::index_sequence<Is...>& seq,
-  const ref<T>& initial,
-  dtime t0,
-  const core::enable_if_any_t<
-    void,
-    core::is_init_function<decltype(
-      std::get<Is>(std::declval<std::tuple<Trs...>>()).second)>...>* = nullptr)
-{
-  struct helper
+template <typename T> struct prev_policy
+{
+  static std::string label()
   {
-    static ref<internal::transition> make_case(integer idx, std::false_type)
-    {
-      return Const<internal::transition>(idx, dtimestamp());
-    }
-
-    static init_function<internal::transition> make_case(integer idx,
-                                                         std::true_type)
-    {
-      return [=](dtime t0) { return internal::Transition(idx, t0); };
-    }
-  };
+    return "prev";
+  }
 
-  const auto tr = Recursion(
-    internal::Transition(0, t0),
-    [=](ref<internal::transition> sp) {
-      return Switch(
-        Case(std::get<Is>(transitions).first,
-             helper::make_case(static_cast<integer>(Is) + 1,
-                               core::is_init_function<decltype(
-                                 std::get<Is>(transitions).second)>()))...,
-        Default(sp));
-    },
-    t0);
+  static const T& calculate(const T&, const T& prev)
+  {
+    return prev;
+  }
+};
 
-  const auto tr_idx = Index(tr);
+template <typename X, typename T> struct diff_policy
+{
+  static std::string label()
+  {
+    return "diff";
+  }
 
-  return Since(When(tr) == CurrentTime(),
-               Switch(Case(tr_idx == Const(static_cast<integer>(Is) + 1),
-                           std::get<Is>(transitions).second)...,
-                      Default(initial)),
-               t0);
-}
+  static T calculate(const X& curr, const X& prev)
+  {
+    return curr - prev;
+  }
+};
+
+template <typename X, typename T, typename F> class accumulate_policy
+{
+public:
+  accumulate_policy(const F& f, const T& init)
+  : f_(f)
+  , init_(init)
+  {
+  }
+
+  static std::string label()
+  {
+    return "accumulate";
+  }
+
+  T calculate(const X& x) const
+  {
+    return f_(init_, x);
+  }
+
+  T update(const T& acc, const X& x) const
+  {
+    return f_(acc, x);
+  }
+
+private:
+  F f_;
+  T init_;
+};
+
+template <typename T> struct hold_policy
+{
+  static std::string label()
+  {
+    return "hold";
+  }
+
+  static const T& calculate(const T& x, bool)
+  {
+    return x;
+  }
+
+  static const T& update(const T& v, const T& x, bool trigger)
+  {
+    return trigger ? x : v;
+  }
+};
 
+template <typename T> struct state_machine_target
+{
+  static std::pair<ref<T>, bool> make(const ref<T>& x)
+  {
+    return std::make_pair(x, false);
+  }
+
+  static std::pair<ref<T>, bool> make(const init_function<T>& f)
+  {
+    return std::make_pair(
+      core::ref_base<T>(dataflow::internal::node_compound<T>::create(f),
+                        dataflow::internal::ref::ctor_guard),
+      true);
+  }
+};
+
+// The conditions are checked by a single activator, and taking a transition
+// (de)activates just the states it leaves and enters
 template <typename T, typename... Trs, std::size_t... Is>
-ref<T> make_state_machine(
-  const std::tuple<Trs...>& transitions,
-  const std14::index_sequence<Is...>& seq,
-  const ref<T>& initial,
-  dtime t0,
-  const core::enable_if_none_t<
-    void,
-    core::is_init_function<decltype(
-      std::get<Is>(std::declval<std::tuple<Trs...>>()).second)>...>* = nullptr)
-{
-  const auto tr_idx = Recursion(
-    0,
-    [=](ref<integer> sp) {
-      return Switch(Case(std::get<Is>(transitions).first,
-                         Const(static_cast<integer>(Is) + 1))...,
-                    Default(sp));
-    },
-    t0);
+ref<T> make_state_machine(const std::tuple<Trs...>& transitions,
+                          const std14::index_sequence<Is...>&,
+                          const ref<T>& initial)
+{
+  const std::array<dataflow::internal::ref, sizeof...(Is)> conditions = {
+    {std::get<Is>(transitions).first...}};
+
+  const std::array<std::pair<ref<T>, bool>, sizeof...(Is)> targets = {
+    {state_machine_target<T>::make(std::get<Is>(transitions).second)...}};
+
+  std::vector<dataflow::internal::ref> states;
+  std::vector<bool> restartable;
 
-  return Switch(Case(tr_idx == Const(static_cast<integer>(Is) + 1),
-                     std::get<Is>(transitions).second)...,
-                Default(initial));
+  states.reserve(1 + targets.size());
+  restartable.reserve(targets.size());
+
+  states.push_back(initial);
+
+  for (const auto& target : targets)
+  {
+    states.push_back(target.first);
+    restartable.push_back(target.second);
+  }
+
+  return core::ref_base<T>(
+    dataflow::internal::node_switch<T>::create(
+      dataflow::internal::node_state_machine_activator::create(
+        conditions.data(), conditions.size(), std::move(restartable)),
+      states.data(),
+      states.size(),
+      false),
+    dataflow::internal::ref::ctor_guard);
 }
 
 }
@@ -138,15 +197,14 @@ dataflow::StateMachine(const ArgT& initial, const F& f, dtime t0)
   return Recursion(
     initial_arg,
     [=](const ref<T>& sp) {
-      return [=](dtime t0) {
+      return [=](dtime) {
         const auto transitions = f(sp);
 
         return stateful::detail::make_state_machine(
           transitions,
           std14::make_index_sequence<
             std::tuple_size<decltype(transitions)>::value>(),
-          initial_arg,
-          t0);
+          initial_arg);
       };
     },
     t0);
@@ -180,9 +238,25 @@ dataflow::ref<T> dataflow::Prev(const ArgV0& v0, const ArgX& x, dtime t0)
 {
   using namespace stateful::internal;
 
+  using node_type =
+    internal::node_prev<stateful::detail::prev_policy<T>, T, T>;
+
+  const auto v0_ref = core::make_argument(v0);
+  const auto x_ref = core::make_argument(x);
+
+  if (v0_ref.id() == x_ref.id())
+    return core::ref_base<T>(node_type::create({}, x_ref),
+                             internal::ref::ctor_guard);
+
+  if (internal::nodes_factory::is_constant(v0_ref))
+    return core::ref_base<T>(
+      node_type::create({}, x_ref, v0_ref.template value<T>()),
+      internal::ref::ctor_guard);
+
+  // The initial value has to be calculated at `t0` and released afterwards
   return Prev(Recursion(
-    CurrPrev(x, v0),
-    [=](const ref<curr_prev<T>>& pv) { return CurrPrev(x, Curr(pv)); },
+    CurrPrev(x_ref, v0_ref),
+    [=](const ref<curr_prev<T>>& pv) { return CurrPrev(x_ref, Curr(pv)); },
     t0));
 }
 
@@ -195,9 +269,12 @@ dataflow::init_function<T> dataflow::Prev(const ArgV0& v0, const ArgX& x)
 }
 
 template <typename ArgX, typename..., typename X, typename T>
-dataflow::ref<T> dataflow::Diff(const ArgX& x, dtime t0)
+dataflow::ref<T> dataflow::Diff(const ArgX& x, dtime)
 {
-  return x - Prev(x, x, t0);
+  return core::ref_base<T>(
+    internal::node_prev<stateful::detail::diff_policy<X, T>, T, X>::create(
+      {}, core::make_argument(x)),
+    internal::ref::ctor_guard);
 }
 
 template <typename ArgX, typename..., typename X, typename T>
@@ -205,3 +282,25 @@ dataflow::init_function<T> dataflow::Diff(const ArgX& x)
 {
   return [x = core::make_argument(x)](dtime t0) { return Diff(x, t0); };
 }
+
+template <typename ArgX,
+          typename F,
+          typename T,
+          typename...,
+          typename X,
+          typename U,
+          typename>
+dataflow::ref<U>
+dataflow::Accumulate(const ArgX& x, const F& f, const T& init)
+{
+  return core::LiftUpdater(
+    stateful::detail::accumulate_policy<X, U, F>(f, init),
+    core::make_argument(x));
+}
+
+template <typename ArgX, typename ArgTrigger, typename..., typename T, typename>
+dataflow::ref<T> dataflow::Hold(const ArgX& x, const ArgTrigger& trigger)
+{
+  return core::LiftUpdater<stateful::detail::hold_policy<T>>(
+    core::make_argument(x), core::make_argument(trigger));
+}
@@ -301,9 +301,14 @@ introspect::dependency_graph::vertices_size_type introspect::num_updated_nodes()
   return internal::engine::instance().updated_nodes_count();
 }
 
+bool introspect::is_graph_frozen()
+{
+  return internal::engine::instance().is_frozen();
+}
+
 std::size_t introspect::memory_consumption()
 {
-  return internal::engine::allocator_type::allocated();
+  return internal::engine::instance().memory_consumption();
 }
 
 // Vertex properties
@@ -29,6 +29,14 @@ dataflow::console::Input(dtime t0, const ref<std::string>& prompt)
     {
       return "Input";
     }
+    static bool concurrent()
+    {
+      return false;
+    }
+    static bool retainable()
+    {
+      return false;
+    }
     static std::string calculate(const std::string& prompt)
     {
       std::cout << prompt;
@@ -53,6 +61,14 @@ dataflow::console::Error(dtime t0, const ref<std::string>& message)
     {
       return "Error";
     }
+    static bool concurrent()
+    {
+      return false;
+    }
+    static bool retainable()
+    {
+      return false;
+    }
     static std::string calculate(const std::string& s)
     {
       std::cerr << s << std::endl;
@@ -72,6 +88,14 @@ dataflow::console::Log(dtime t0, const ref<std::string>& message)
     {
       return "Log";
     }
+    static bool concurrent()
+    {
+      return false;
+    }
+    static bool retainable()
+    {
+      return false;
+    }
     static std::string calculate(const std::string& s)
     {
       std::clog << s << std::endl;
@@ -91,6 +115,14 @@ dataflow::console::Output(dtime t0, const ref<std::string>& message)
     {
       return "Output";
     }
+    static bool concurrent()
+    {
+      return false;
+    }
+    static bool retainable()
+    {
+      return false;
+    }
     static std::string calculate(const std::string& s)
     {
       std::cout << s << std::endl;
@@ -19,11 +19,27 @@
 #include <dataflow/prelude/core.h>
 
 #include "core/internal/engine.h"
+#include "core/internal/input_queue.h"
 
 #include <dataflow/prelude/core/internal/node_signal.h>
 
+#include <exception>
+#include <unordered_set>
+
 namespace dataflow
 {
+namespace
+{
+int uncaught_exceptions_count()
+{
+#if defined(__cpp_lib_uncaught_exceptions)
+  return std::uncaught_exceptions();
+#else
+  return std::uncaught_exception() ? 1 : 0;
+#endif
+}
+}
+
 bool unit::operator==(const unit&) const
 {
   return true;
@@ -42,9 +58,10 @@ std::ostream& dataflow::operator<<(std::ostream& out, const unit&)
 
 namespace dataflow
 {
-Engine::Engine(engine_options options)
+Engine::Engine(engine_options options, std::size_t retention_period)
+: p_inputs_(new internal::input_queue())
 {
-  internal::engine::start(this, options);
+  internal::engine::start(this, p_inputs_.get(), options, retention_period);
 }
 
 Engine::~Engine()
@@ -52,6 +69,79 @@ Engine::~Engine()
   internal::engine::stop();
 }
 
+void Engine::Post(const sig& s)
+{
+  post_(std::unique_ptr<internal::posted_input>(
+    new internal::posted_signal(s.id())));
+}
+
+void Engine::Drain()
+{
+  DATAFLOW___CHECK_PRECONDITION(internal::engine::data() == this);
+
+  auto& e = internal::engine::instance();
+
+  e.publish_async_results();
+
+  const bool conflation =
+    (e.get_options() & engine_options::input_conflation) !=
+    engine_options::nothing;
+
+  auto p_first = p_inputs_->take_all();
+
+  // The latest inputs come first, which is what the conflation needs;
+  // otherwise they are applied in the order they have been posted
+  if (!conflation)
+    p_first = internal::input_queue::reverse(p_first);
+
+  const std::unique_ptr<internal::posted_input,
+                        void (*)(internal::posted_input*)>
+    guard(p_first, &internal::input_queue::destroy);
+
+  const auto apply = [&e](internal::posted_input& input) {
+    const auto v = internal::converter::convert(input.id());
+
+    if (input.apply(e.get_node(v)))
+      e.schedule_input(v);
+  };
+
+  // Every input gets an update of its own, so that no value is skipped
+  if (!conflation)
+  {
+    for (auto p = p_first; p; p = p->p_next)
+    {
+      if (p->expired())
+        continue;
+
+      const Transaction tx;
+
+      apply(*p);
+    }
+
+    return;
+  }
+
+  std::unordered_set<internal::node_id> applied;
+
+  const Transaction tx;
+
+  for (auto p = p_first; p; p = p->p_next)
+  {
+    if (p->expired())
+      continue;
+
+    if (p->conflatable() && !applied.insert(p->id()).second)
+      continue;
+
+    apply(*p);
+  }
+}
+
+void Engine::post_(std::unique_ptr<internal::posted_input> p_input)
+{
+  p_inputs_->push(std::move(p_input));
+}
+
 Engine* Engine::engine_()
 {
   return static_cast<Engine*>(internal::engine::data());
@@ -106,6 +196,22 @@ ref<bool> Engine::timeout_(const ref<integer>& interval_msec, dtime t0)
   return core::Lift<active_policy>(s);
 }
 
+Transaction::Transaction()
+: uncaught_exceptions_(uncaught_exceptions_count())
+{
+  internal::engine::instance().start_transaction();
+}
+
+Transaction::~Transaction() noexcept(false)
+{
+  auto& e = internal::engine::instance();
+
+  if (uncaught_exceptions_count() > uncaught_exceptions_)
+    e.abort_transaction();
+  else
+    e.commit_transaction();
+}
+
 const ref<bool>& sig::as_ref() const
 {
   return *this;
@@ -0,0 +1,158 @@
+//  Copyright (c) 2014 - 2021 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "memory_context.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace dataflow
+{
+namespace internal
+{
+/// Allocator placing single objects of the same size into the arenas of a
+/// memory context. Array allocations fall back to `std::allocator`.
+template <typename T> class arena_allocator
+{
+  template <typename U> friend class arena_allocator;
+
+public:
+  using value_type = T;
+
+  template <typename U> struct rebind
+  {
+    using other = arena_allocator<U>;
+  };
+
+public:
+  arena_allocator()
+  : arena_allocator(memory_context::current())
+  {
+  }
+
+  explicit arena_allocator(memory_context& context)
+  : p_context_(&context)
+  , p_arena_(&context.get_arena(sizeof(T), alignof(T)))
+  {
+  }
+
+  template <typename U>
+  arena_allocator(const arena_allocator<U>& other)
+  : arena_allocator(*other.p_context_)
+  {
+  }
+
+  T* allocate(std::size_t n)
+  {
+    if (n != 1)
+      return std::allocator<T>().allocate(n);
+
+    return static_cast<T*>(p_arena_->allocate());
+  }
+
+  void deallocate(T* p, std::size_t n)
+  {
+    if (n != 1)
+      return std::allocator<T>().deallocate(p, n);
+
+    p_arena_->deallocate(p);
+  }
+
+  template <typename U>
+  bool operator==(const arena_allocator<U>& other) const
+  {
+    return p_context_ == other.p_context_;
+  }
+
+  template <typename U>
+  bool operator!=(const arena_allocator<U>& other) const
+  {
+    return !(*this == other);
+  }
+
+private:
+  memory_context* p_context_;
+  detail::arena* p_arena_;
+};
+
+/// Bump allocator releasing all its allocations at once. The memory is kept
+/// for reuse, so after warming up `allocate()` is just a pointer increment.
+/// Objects allocated in the arena are not destroyed by `reset()`.
+class monotonic_arena final
+{
+public:
+  explicit monotonic_arena(std::size_t chunk_size = 4096)
+  : chunk_size_(chunk_size)
+  , chunks_()
+  , chunk_idx_(0)
+  , offset_(0)
+  {
+  }
+
+  monotonic_arena(const monotonic_arena&) = delete;
+  monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+  void* allocate(std::size_t size, std::size_t alignment)
+  {
+    for (;; ++chunk_idx_, offset_ = 0)
+    {
+      if (chunk_idx_ == chunks_.size())
+      {
+        const auto new_size = std::max(chunk_size_, size + alignment);
+
+        chunks_.push_back(chunk{std::unique_ptr<char[]>(new char[new_size]),
+                                new_size});
+      }
+
+      const auto& c = chunks_[chunk_idx_];
+
+      void* p = c.p_data.get() + offset_;
+      auto space = c.size - offset_;
+
+      if (std::align(alignment, size, p, space))
+      {
+        offset_ = c.size - space + size;
+        return p;
+      }
+    }
+  }
+
+  void reset()
+  {
+    chunk_idx_ = 0;
+    offset_ = 0;
+  }
+
+private:
+  struct chunk
+  {
+    std::unique_ptr<char[]> p_data;
+    std::size_t size;
+  };
+
+private:
+  const std::size_t chunk_size_;
+  std::vector<chunk> chunks_;
+  std::size_t chunk_idx_;
+  std::size_t offset_;
+};
+} // internal
+} // dataflow
@@ -0,0 +1,99 @@
+
+//  Copyright (c) 2014 - 2021 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+
+#include "async_pool.h"
+
+#include "config.h"
+
+#include <utility>
+
+namespace dataflow
+{
+namespace internal
+{
+async_pool::async_pool(std::size_t workers_count)
+: threads_()
+, mutex_()
+, cv_()
+, tasks_()
+, stopping_(false)
+{
+  CHECK_PRECONDITION(workers_count > 0);
+
+  threads_.reserve(workers_count);
+
+  for (std::size_t i = 0; i < workers_count; ++i)
+    threads_.emplace_back([this]() { work_(); });
+}
+
+async_pool::~async_pool() noexcept
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    stopping_ = true;
+    tasks_.clear();
+  }
+
+  cv_.notify_all();
+
+  for (auto& thread : threads_)
+    thread.join();
+}
+
+void async_pool::submit(task_function f)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    tasks_.push_back(std::move(f));
+  }
+
+  cv_.notify_one();
+}
+
+void async_pool::work_()
+{
+  for (;;)
+  {
+    task_function f;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      cv_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+
+      if (stopping_)
+        return;
+
+      f = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+
+    // A failed task just doesn't deliver its result
+    try
+    {
+      f();
+    }
+    catch (...)
+    {
+    }
+  }
+}
+} // internal
+} // dataflow
@@ -0,0 +1,62 @@
+
+//  Copyright (c) 2014 - 2021 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dataflow
+{
+namespace internal
+{
+/// Pool of threads running independent tasks in the order they have been
+/// submitted. Unlike `worker_pool`, the submitting thread doesn't wait for
+/// the tasks. Pending tasks are dropped when the pool gets destroyed, while
+/// the running ones are waited for.
+class async_pool final
+{
+public:
+  using task_function = std::function<void()>;
+
+public:
+  explicit async_pool(std::size_t workers_count);
+  ~async_pool() noexcept;
+
+  async_pool(const async_pool&) = delete;
+  async_pool& operator=(const async_pool&) = delete;
+
+  void submit(task_function f);
+
+private:
+  void work_();
+
+private:
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<task_function> tasks_;
+  bool stopping_;
+};
+} // internal
+} // dataflow
@@ -23,20 +23,33 @@
 
 #include <dst/allocator/utility.h>
 
+#include <algorithm>
 #include <cstdint> // std::intptr_t
 #include <stack>
+#include <thread>
+#include <unordered_set>
 
 namespace dataflow
 {
 namespace internal
 {
-engine* engine::gp_engine_ = nullptr;
+namespace
+{
+// Bounds the number of stable pumps needed to freeze the graph, and is the
+// number of pumps a snapshot has to survive to halve it
+const std::size_t max_freeze_delay = 64;
+}
+
+thread_local engine* engine::gp_engine_ = nullptr;
 
-void engine::start(void* p_data, engine_options options)
+void engine::start(void* p_data,
+                   input_queue* p_inputs,
+                   engine_options options,
+                   std::size_t retention_period)
 {
   CHECK_PRECONDITION(gp_engine_ == nullptr);
 
-  gp_engine_ = new engine(p_data, options);
+  gp_engine_ = new engine(p_data, p_inputs, options, retention_period);
 
   const auto p_node = static_cast<node_time*>(dst::memory::allocate_aligned(
     gp_engine_->get_allocator(), sizeof(node_time), alignof(node_time)));
@@ -81,16 +94,20 @@ dtimestamp engine::current_time() const
 }
 
 vertex_descriptor engine::add_node(node* p_node,
+                                   update_function p_update,
                                    const node_id* p_args,
                                    std::size_t args_count,
                                    bool eager,
                                    bool conditional,
-                                   bool pump)
+                                   bool pump,
+                                   bool concurrent,
+                                   bool retainable)
 {
   CHECK_ARGUMENT(!pump || eager); // pump => (implies) eager
   CHECK_PRECONDITION(p_node != nullptr);
+  CHECK_PRECONDITION(p_update != nullptr);
 
-  const auto v = add_vertex(vertex(p_node), graph_);
+  const auto v = add_vertex(vertex(p_node, p_update), graph_);
 
   for (std::size_t i = 0; i < args_count; ++i)
   {
@@ -100,11 +117,16 @@ vertex_descriptor engine::add_node(node* p_node,
   }
 
   graph_[v].conditional = conditional;
+  graph_[v].concurrent = concurrent;
+  graph_[v].retainable = retainable;
 
   if (eager)
   {
     graph_[v].eager = true;
 
+    if ((options_ & engine_options::chain_fusion) != engine_options::nothing)
+      fuse_chains_(v);
+
     activate_vertex_(v, new_topological_pos_(order_.end(), v), order_.front());
 
     order_.mark(graph_[v].position);
@@ -115,9 +137,9 @@ vertex_descriptor engine::add_node(node* p_node,
 
     --es.second;
 
-    for (; es.first != es.second; ++es.first)
+    for (std::size_t idx = 0; es.first != es.second; ++es.first, ++idx)
     {
-      activate_subgraph_(*es.first);
+      activate_subgraph_(*es.first, idx);
 
       if (conditional)
         break;
@@ -133,7 +155,7 @@ vertex_descriptor engine::add_node(node* p_node,
     CHECK_CONDITION(eager);
     CHECK_CONDITION(order_.marked(graph_[v].position));
 
-    pumpa_.pump(graph_, order_, time_node_v_);
+    pump_();
   }
 
   return v;
@@ -154,6 +176,65 @@ vertex_descriptor engine::add_persistent_node(node* p_node)
   return v;
 }
 
+vertex_descriptor engine::find_interned_node(
+  update_function p_type,
+  std::size_t hash,
+  const node_id* p_args,
+  std::size_t args_count,
+  bool (*p_equal)(const node* p_node, const void* p_value),
+  const void* p_value) const
+{
+  if ((options_ & engine_options::hash_consing) == engine_options::nothing)
+    return vertex_descriptor();
+
+  const auto range =
+    interned_.equal_range(interned_key_(p_type, hash, p_args, args_count));
+
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    const auto v = it->second.v;
+
+    if (it->second.p_type != p_type)
+      continue;
+
+    if (p_equal && !p_equal(graph_[v].p_node, p_value))
+      continue;
+
+    // The logical edge of an active vertex is the last one
+    const auto data_edges_count =
+      out_degree(v, graph_) - (is_active_node(v) ? 1 : 0);
+
+    if (data_edges_count != args_count)
+      continue;
+
+    std::size_t i = 0;
+
+    while (i < args_count &&
+           target(out_edge_at_(v, i), graph_) == converter::convert(p_args[i]))
+      ++i;
+
+    if (i == args_count)
+      return v;
+  }
+
+  return vertex_descriptor();
+}
+
+void engine::intern_node(vertex_descriptor v,
+                         update_function p_type,
+                         std::size_t hash,
+                         const node_id* p_args,
+                         std::size_t args_count)
+{
+  if ((options_ & engine_options::hash_consing) == engine_options::nothing)
+    return;
+
+  const auto key = interned_key_(p_type, hash, p_args, args_count);
+
+  interned_.emplace(key, interned_info{v, p_type});
+  interned_hashes_.emplace(v, key);
+}
+
 void engine::add_data_edge(vertex_descriptor u, vertex_descriptor v)
 {
   CHECK_PRECONDITION(!is_active_node(u));
@@ -181,7 +262,83 @@ void engine::schedule_and_pump(vertex_descriptor v)
 
   order_.mark(graph_[v].position);
 
-  pumpa_.pump(graph_, order_, time_node_v_);
+  if (!is_in_transaction())
+    pump_();
+}
+
+void engine::schedule_input(vertex_descriptor v)
+{
+  if (is_active_node(v))
+  {
+    if (is_pumping())
+    {
+      schedule_for_next_update(v);
+    }
+    else
+    {
+      schedule_and_pump(v);
+    }
+  }
+  else
+  {
+    // The retained value is outdated now
+    discard_retained_value(v);
+  }
+}
+
+void engine::run_async(std::function<std::unique_ptr<posted_input>()> f)
+{
+  if (!p_async_)
+  {
+    const std::size_t threads_count = std::thread::hardware_concurrency();
+
+    p_async_.reset(new async_pool(std::max<std::size_t>(1, threads_count)));
+  }
+
+  const auto p_results = &async_results_;
+
+  p_async_->submit([p_results, f]() {
+    if (auto p_result = f())
+      p_results->push(std::move(p_result));
+  });
+}
+
+void engine::publish_async_results()
+{
+  CHECK_PRECONDITION(!is_pumping());
+
+  publish_async_results_();
+
+  if (!is_in_transaction() && order_.begin_marked() != order_.end_marked())
+    pump_();
+}
+
+void engine::start_transaction()
+{
+  ++transaction_depth_;
+}
+
+void engine::commit_transaction()
+{
+  CHECK_PRECONDITION(is_in_transaction());
+
+  if (--transaction_depth_ != 0 || is_pumping())
+    return;
+
+  if (order_.begin_marked() != order_.end_marked())
+    pump_();
+}
+
+void engine::abort_transaction()
+{
+  CHECK_PRECONDITION(is_in_transaction());
+
+  --transaction_depth_;
+}
+
+bool engine::is_in_transaction() const
+{
+  return transaction_depth_ != 0;
 }
 
 void engine::schedule_for_next_update(vertex_descriptor v)
@@ -192,21 +349,41 @@ void engine::schedule_for_next_update(vertex_descriptor v)
   pumpa_.schedule_for_next_update(graph_[v].position);
 }
 
+void engine::discard_retained_value(vertex_descriptor v)
+{
+  CHECK_PRECONDITION(!is_active_node(v));
+
+  const auto it = retained_.find(v);
+
+  if (it == retained_.end())
+    return;
+
+  deactivate_node_(v);
+
+  retained_.erase(it);
+}
+
 bool engine::is_pumping() const
 {
   return pumpa_.is_pumping();
 }
 
+void* engine::allocate_metadata(std::size_t size, std::size_t alignment)
+{
+  return pumpa_.allocate_metadata(size, alignment);
+}
+
 void engine::set_metadata(const node* p_node,
-                          std::shared_ptr<const metadata> p_metadata)
+                          const metadata* p_metadata,
+                          bool owned)
 {
   // TODO: check if the node is active
-  return pumpa_.set_metadata(p_node, p_metadata);
+  pumpa_.set_metadata(p_node, p_metadata, owned);
 }
 
-const std::shared_ptr<const metadata>& engine::get_metadata(const node* p_node)
+void engine::forget_metadata(const node* p_node)
 {
-  return pumpa_.get_metadata(p_node);
+  pumpa_.forget_metadata(p_node);
 }
 
 update_status engine::update_node_if_activator(vertex_descriptor v,
@@ -220,7 +397,7 @@ update_status engine::update_node_if_activator(vertex_descriptor v,
   {
     const auto e = *(out_edges(w, graph_).first + 1 + new_value);
 
-    activate_subgraph_(e);
+    activate_subgraph_(e, 1 + new_value);
 
     return update_status::updated;
   }
@@ -231,9 +408,9 @@ update_status engine::update_node_if_activator(vertex_descriptor v,
       const auto e_prev = out_edge_at_(w, 1 + old_value);
       const auto e_curr = out_edge_at_(w, 1 + new_value);
 
-      deactivate_subgraph_(e_prev);
+      deactivate_subgraph_(e_prev, 1 + old_value);
 
-      activate_subgraph_(e_curr);
+      activate_subgraph_(e_curr, 1 + new_value);
 
       return update_status::updated;
     }
@@ -269,12 +446,15 @@ update_status engine::update_node_selector_activator(vertex_descriptor v,
 
     CHECK_CONDITION(out_degree(w, graph_) == 4);
 
-    activate_subgraph_(new_e);
+    activate_subgraph_(new_e, 2);
 
-    deactivate_subgraph_(old_e);
+    deactivate_subgraph_(old_e, 1);
     release(old_x);
     remove_edge(old_e, graph_);
 
+    // The new argument has moved to the place of the old one
+    update_args_(w);
+
     CHECK_CONDITION(out_degree(w, graph_) == 3);
   }
   else
@@ -292,7 +472,7 @@ update_status engine::update_node_selector_activator(vertex_descriptor v,
 
     CHECK_CONDITION(out_degree(w, graph_) == 3);
 
-    activate_subgraph_(new_e);
+    activate_subgraph_(new_e, 1);
   }
 
   return update_status::updated;
@@ -307,16 +487,40 @@ update_status engine::update_node_snapshot_activator(vertex_descriptor v,
 
   if (!initialized)
   {
-    activate_subgraph_(e);
+    activate_subgraph_(e, 1);
 
     return update_status::updated | update_status::updated_next;
   }
 
-  deactivate_subgraph_(e);
+  deactivate_subgraph_(e, 1);
 
   return update_status::nothing;
 }
 
+update_status
+engine::update_node_state_machine_activator(vertex_descriptor v,
+                                            bool initialized,
+                                            std::size_t new_value,
+                                            std::size_t old_value,
+                                            bool restart)
+{
+  // Re-entering the current state starts it over, as `Since()` does
+  if (initialized && restart && new_value == old_value)
+  {
+    const auto w = main_consumer_(v);
+
+    const auto e = out_edge_at_(w, 1 + new_value);
+
+    deactivate_subgraph_(e, 1 + new_value);
+
+    activate_subgraph_(e, 1 + new_value);
+
+    return update_status::updated;
+  }
+
+  return update_node_if_activator(v, initialized, new_value, old_value);
+}
+
 update_status engine::update_node_since_activator(vertex_descriptor v,
                                                   bool initialized,
                                                   bool start_condition)
@@ -327,7 +531,7 @@ update_status engine::update_node_since_activator(vertex_descriptor v,
 
     const auto e = *(out_edges(w, graph_).first + 1);
 
-    activate_subgraph_(e);
+    activate_subgraph_(e, 1);
 
     return update_status::updated;
   }
@@ -339,9 +543,9 @@ update_status engine::update_node_since_activator(vertex_descriptor v,
 
       const auto e = out_edge_at_(w, 1);
 
-      deactivate_subgraph_(e);
+      deactivate_subgraph_(e, 1);
 
-      activate_subgraph_(e);
+      activate_subgraph_(e, 1);
 
       return update_status::updated;
     }
@@ -379,7 +583,7 @@ engine::update_node_recursion_activator(vertex_descriptor v, bool initialized)
   {
     CHECK_PRECONDITION(!is_active_data_dependency(e_init));
 
-    activate_subgraph_(e_init);
+    activate_subgraph_(e_init, 1);
 
     CHECK_POSTCONDITION(is_active_data_dependency(e_init));
     CHECK_POSTCONDITION(!is_active_data_dependency(e_regular));
@@ -390,8 +594,8 @@ engine::update_node_recursion_activator(vertex_descriptor v, bool initialized)
   {
     if (!is_active_data_dependency(e_regular))
     {
-      deactivate_subgraph_(e_init);
-      activate_subgraph_(e_regular);
+      deactivate_subgraph_(e_init, 1);
+      activate_subgraph_(e_regular, 2);
 
       status = update_status::updated;
     }
@@ -403,8 +607,13 @@ engine::update_node_recursion_activator(vertex_descriptor v, bool initialized)
   return std::make_pair(graph_[u].p_node, status);
 }
 
-engine::engine(void* p_data, engine_options options)
-: allocator_()
+engine::engine(void* p_data,
+               input_queue* p_inputs,
+               engine_options options,
+               std::size_t retention_period)
+: memory_()
+, memory_scope_(memory_)
+, allocator_()
 , p_data_(p_data)
 , options_(options)
 , graph_()
@@ -416,12 +625,30 @@ engine::engine(void* p_data, engine_options options)
 , pumpa_(allocator_, options)
 , ticks_()
 , time_node_v_()
+, transaction_depth_(0)
+, retention_period_(retention_period)
+, retained_(allocator_)
+, pumps_count_(0)
+, last_expiration_pump_(0)
+, structure_version_(0)
+, pumped_structure_version_(0)
+, stable_pumps_count_(0)
+, freeze_delay_(1)
+, frozen_pumps_count_(0)
+, interned_(allocator_)
+, interned_hashes_(allocator_)
+, fused_(allocator_)
+, p_inputs_(p_inputs)
+, async_results_()
+, p_async_()
 {
+  CHECK_PRECONDITION(p_inputs_ != nullptr);
 }
 
 engine::~engine() noexcept
 {
   CHECK_PRECONDITION_NOEXCEPT(num_vertices(graph_) == 1);
+  CHECK_PRECONDITION_NOEXCEPT(!is_in_transaction());
 
   try
   {
@@ -482,6 +709,8 @@ void engine::remove_from_topological_list_(vertex_descriptor v)
 
   CHECK_PRECONDITION(position != topological_position());
 
+  thaw_();
+
   order_.erase(position);
 
   graph_[v].position = topological_position();
@@ -492,6 +721,8 @@ topological_position engine::new_topological_pos_(topological_position position,
 {
   CHECK_PRECONDITION(position != topological_position());
 
+  thaw_();
+
   return order_.insert(position, v);
 }
 
@@ -502,14 +733,188 @@ void engine::delete_node_(vertex_descriptor v)
 
   const auto p_node = graph_[v].p_node;
 
+  // A retained vertex still owes its node the deactivation
+  if (retained_.count(v) != 0)
+  {
+    deactivate_node_(v);
+    retained_.erase(v);
+  }
+
+  forget_interned_(v);
+
+  const auto it = fused_.find(v);
+
+  if (it != fused_.end())
+  {
+    for (const auto& stage : it->second.stages)
+      destroy_node_(stage.p_node);
+
+    fused_.erase(it);
+  }
+
+  destroy_node_(p_node);
+
+  remove_vertex(v, graph_);
+}
+
+void engine::destroy_node_(node* p_node)
+{
+  pumpa_.forget_metadata(p_node);
+
   const auto info = p_node->mem_info();
 
   p_node->~node();
 
   dst::memory::deallocate_aligned(
     get_allocator(), p_node, info.first, info.second);
+}
 
-  remove_vertex(v, graph_);
+void engine::forget_interned_(vertex_descriptor v)
+{
+  const auto it = interned_hashes_.find(v);
+
+  if (it == interned_hashes_.end())
+    return;
+
+  const auto range = interned_.equal_range(it->second);
+
+  interned_.erase(
+    std::find_if(range.first, range.second, [v](const auto& item) {
+      return item.second.v == v;
+    }));
+
+  interned_hashes_.erase(it);
+}
+
+void engine::activate_node_(vertex_descriptor v)
+{
+  const auto id = converter::convert(v);
+
+  const auto p_fused = graph_[v].p_fused;
+
+  if (p_fused)
+  {
+    for (const auto& stage : p_fused->stages)
+      stage.p_node->activate(id, ticks_);
+  }
+
+  graph_[v].p_node->activate(id, ticks_);
+}
+
+void engine::deactivate_node_(vertex_descriptor v)
+{
+  const auto id = converter::convert(v);
+
+  const auto p_fused = graph_[v].p_fused;
+
+  if (p_fused)
+  {
+    for (const auto& stage : p_fused->stages)
+      stage.p_node->deactivate(id);
+  }
+
+  graph_[v].p_node->deactivate(id);
+
+  // The node has lost its value, so the values retained by its consumers are
+  // outdated even if it gets the same value back
+  graph_[v].changed_at = pumpa_.new_change_stamp();
+}
+
+bool engine::is_fusable_(vertex_descriptor v) const
+{
+  // Only pure nodes which have never been activated, or have been fully
+  // deactivated, change their shape
+  return !is_active_node(v) && !is_persistent_node(v) &&
+         graph_[v].retainable && !graph_[v].eager && !graph_[v].conditional &&
+         retained_.count(v) == 0;
+}
+
+void engine::fuse_chains_(vertex_descriptor v)
+{
+  std::stack<vertex_descriptor> stack;
+  std::unordered_set<vertex_descriptor> visited;
+
+  stack.push(v);
+
+  while (!stack.empty())
+  {
+    const auto u = stack.top();
+    stack.pop();
+
+    if (!visited.insert(u).second || is_active_node(u))
+      continue;
+
+    if (is_fusable_(u))
+      fuse_chain_(u);
+
+    for (auto es = out_edges(u, graph_); es.first != es.second; ++es.first)
+    {
+      if (!is_logical_dependency(*es.first))
+        stack.push(target(*es.first, graph_));
+    }
+  }
+}
+
+void engine::fuse_chain_(vertex_descriptor v)
+{
+  CHECK_PRECONDITION(is_fusable_(v));
+
+  // Stages are collected from the last one to the first one
+  std::vector<fused_stage> stages;
+
+  while (out_degree(v, graph_) == 1)
+  {
+    const auto e = *out_edges(v, graph_).first;
+    const auto w = target(e, graph_);
+
+    // The node must have no other consumers, which would see its value
+    if (!is_fusable_(w) || graph_[w].ref_count() != 1)
+      break;
+
+    stages.push_back(fused_stage{graph_[w].p_node, graph_[w].p_update});
+
+    const auto it = fused_.find(w);
+
+    if (it != fused_.end())
+    {
+      stages.insert(stages.end(),
+                    it->second.stages.rbegin(),
+                    it->second.stages.rend());
+      fused_.erase(it);
+    }
+
+    // The arguments of the absorbed node become the arguments of `v`
+    for (auto es = out_edges(w, graph_); es.first != es.second; ++es.first)
+      add_data_edge_(v, target(*es.first, graph_));
+
+    remove_edge(e, graph_);
+
+    while (out_degree(w, graph_) != 0)
+    {
+      const auto e = *out_edges(w, graph_).first;
+      const auto u = target(e, graph_);
+
+      remove_edge(e, graph_);
+
+      CHECK_CONDITION(!graph_[u].release());
+    }
+
+    forget_interned_(w);
+
+    remove_vertex(w, graph_);
+  }
+
+  if (stages.empty())
+    return;
+
+  forget_interned_(v);
+
+  // The chains are node-based, so the pointer survives rehashing
+  auto& chain = fused_[v];
+
+  graph_[v].p_fused = &chain;
+
+  chain.stages.insert(chain.stages.begin(), stages.rbegin(), stages.rend());
 }
 
 void engine::activate_vertex_(vertex_descriptor v,
@@ -520,7 +925,19 @@ void engine::activate_vertex_(vertex_descriptor v,
   CHECK_PRECONDITION(*pos == v);
   CHECK_PRECONDITION(graph_[v].p_node != nullptr);
 
-  graph_[v].p_node->activate(converter::convert(v), ticks_);
+  const auto it = retained_.find(v);
+
+  if (it != retained_.end())
+  {
+    // The node has never been deactivated, so it just keeps its value
+    graph_[v].warm = is_retained_value_valid_(v, it->second.stamp);
+
+    retained_.erase(it);
+  }
+  else
+  {
+    activate_node_(v);
+  }
 
   graph_[v].position = pos;
 
@@ -537,11 +954,23 @@ void engine::deactivate_vertex_partially_(vertex_descriptor v)
   CHECK_PRECONDITION(graph_[v].consumers.size() == 0);
   CHECK_PRECONDITION(graph_[v].p_node != nullptr);
 
+  thaw_();
+
+  // A vertex scheduled for update has a stale value, which is not worth
+  // keeping
+  const bool retained =
+    (options_ & engine_options::warm_deactivation) != engine_options::nothing &&
+    graph_[v].retainable && !order_.marked(graph_[v].position);
+
   remove_from_topological_list_(v);
 
   graph_[v].initialized = false;
+  graph_[v].warm = false;
 
-  graph_[v].p_node->deactivate(converter::convert(v));
+  if (retained)
+    retained_.emplace(v, retained_info{pumpa_.change_stamp(), pumps_count_});
+  else
+    deactivate_node_(v);
 
   CHECK_POSTCONDITION(!graph_[v].initialized);
   CHECK_POSTCONDITION(requires_activation(v));
@@ -562,6 +991,8 @@ void engine::move_to_topological_position_(vertex_descriptor v,
   CHECK_PRECONDITION(is_active_node(v));
   CHECK_PRECONDITION(is_active_node(w));
 
+  thaw_();
+
   const bool marked = order_.marked(graph_[v].position);
 
   remove_from_topological_list_(v);
@@ -582,24 +1013,60 @@ void engine::reset_activator_(vertex_descriptor v, vertex_descriptor w)
   add_logical_edge_(v, w);
 }
 
-void engine::activate_edge_(edge_descriptor e)
+void engine::activate_edge_(edge_descriptor e, std::size_t idx)
 {
   CHECK_PRECONDITION(!is_active_data_dependency(e));
+  CHECK_PRECONDITION(out_edge_at_(source(e, graph_), idx) == e);
 
   const auto u = source(e, graph_);
   const auto v = target(e, graph_);
 
+  thaw_();
+
   graph_[v].consumers.push_front(u);
   graph_[e] = graph_[v].consumers.cbegin();
 
+  // The arguments are mostly activated in their order, so the new one tends
+  // to go to the end
+  auto& args = graph_[u].args;
+  auto& arg_edges = graph_[u].arg_edges;
+
+  const auto it = std::lower_bound(
+    arg_edges.begin(), arg_edges.end(), static_cast<std::uint32_t>(idx));
+
+  args.insert(args.begin() + (it - arg_edges.begin()), graph_[v].p_node);
+  arg_edges.insert(it, static_cast<std::uint32_t>(idx));
+
   CHECK_POSTCONDITION(is_active_data_dependency(e));
 }
 
-void engine::deactivate_edge_(edge_descriptor e)
+void engine::deactivate_edge_(edge_descriptor e, std::size_t idx)
+{
+  CHECK_PRECONDITION(out_edge_at_(source(e, graph_), idx) == e);
+
+  const auto u = source(e, graph_);
+
+  release_edge_(e);
+
+  auto& args = graph_[u].args;
+  auto& arg_edges = graph_[u].arg_edges;
+
+  const auto it = std::lower_bound(
+    arg_edges.begin(), arg_edges.end(), static_cast<std::uint32_t>(idx));
+
+  CHECK_CONDITION(it != arg_edges.end() && *it == idx);
+
+  args.erase(args.begin() + (it - arg_edges.begin()));
+  arg_edges.erase(it);
+}
+
+void engine::release_edge_(edge_descriptor e)
 {
   CHECK_PRECONDITION(is_active_data_dependency(e));
   CHECK_PRECONDITION(is_active_node(source(e, graph_)));
 
+  thaw_();
+
   graph_[target(e, graph_)].consumers.erase(graph_[e]);
 
   graph_[e] = active_edge_ticket();
@@ -607,7 +1074,30 @@ void engine::deactivate_edge_(edge_descriptor e)
   CHECK_POSTCONDITION(!is_active_data_dependency(e));
 }
 
-void engine::activate_subgraph_(edge_descriptor e)
+void engine::update_args_(vertex_descriptor v)
+{
+  auto& args = graph_[v].args;
+  auto& arg_edges = graph_[v].arg_edges;
+
+  args.clear();
+  arg_edges.clear();
+
+  std::uint32_t idx = 0;
+
+  for (auto es = out_edges(v, graph_); es.first != es.second; ++es.first, ++idx)
+  {
+    const auto e = *es.first;
+
+    // Only active data dependencies get to the arguments list
+    if (is_active_data_dependency(e))
+    {
+      args.push_back(graph_[target(e, graph_)].p_node);
+      arg_edges.push_back(idx);
+    }
+  }
+}
+
+void engine::activate_subgraph_(edge_descriptor e, std::size_t idx)
 {
   CHECK_PRECONDITION(is_active_node(source(e, graph_)));
   CHECK_PRECONDITION(!is_active_data_dependency(e));
@@ -622,7 +1112,7 @@ void engine::activate_subgraph_(edge_descriptor e)
 
   std::stack<vertex_data> stack;
 
-  activate_edge_(e);
+  activate_edge_(e, idx);
 
   stack.push({e, true, false, false});
 
@@ -657,18 +1147,20 @@ void engine::activate_subgraph_(edge_descriptor e)
           assert(out_degree(v, graph_) >= 2);
 
           const auto e = *out_edges(v, graph_).first;
-          activate_edge_(e);
+          activate_edge_(e, 0);
           stack.push({e, true, false, false});
         }
         else
         {
           assert(out_degree(v, graph_) >= 1);
 
+          std::size_t idx = 0;
+
           for (auto es = out_edges(v, graph_); es.first != es.second - 1;
-               ++es.first)
+               ++es.first, ++idx)
           {
             const auto e = *es.first;
-            activate_edge_(e);
+            activate_edge_(e, idx);
             stack.push({e, true, false, false});
           }
         }
@@ -759,13 +1251,13 @@ void engine::activate_subgraph_(edge_descriptor e)
   return;
 }
 
-void engine::deactivate_subgraph_(edge_descriptor e)
+void engine::deactivate_subgraph_(edge_descriptor e, std::size_t idx)
 {
   CHECK_PRECONDITION(is_active_node(source(e, graph_)));
 
   const auto v = target(e, graph_);
 
-  deactivate_edge_(e);
+  deactivate_edge_(e, idx);
 
   std::stack<vd_handle> stack;
 
@@ -789,12 +1281,15 @@ void engine::deactivate_subgraph_(edge_descriptor e)
 
         if (is_active_data_dependency(e))
         {
-          deactivate_edge_(e);
+          release_edge_(e);
 
           stack.push(target(e, graph_));
         }
       }
 
+      graph_[w].args.clear();
+      graph_[w].arg_edges.clear();
+
       deactivate_vertex_(w);
     }
     else
@@ -843,6 +1338,130 @@ void engine::deactivate_subgraph_(edge_descriptor e)
   }
 }
 
+void engine::pump_()
+{
+  publish_async_results_();
+
+  if (pumps_count_ != 0 && structure_version_ == pumped_structure_version_)
+    ++stable_pumps_count_;
+  else
+    stable_pumps_count_ = 0;
+
+  if (pumpa_.is_frozen())
+  {
+    if (++frozen_pumps_count_ == max_freeze_delay)
+    {
+      frozen_pumps_count_ = 0;
+      freeze_delay_ = std::max<std::size_t>(freeze_delay_ / 2, 1);
+    }
+  }
+  // The graph is frozen once it has kept its structure long enough
+  else if ((options_ & engine_options::frozen_graph) !=
+             engine_options::nothing &&
+           stable_pumps_count_ >= freeze_delay_)
+  {
+    pumpa_.freeze(graph_, order_);
+
+    frozen_pumps_count_ = 0;
+  }
+
+  pumped_structure_version_ = structure_version_;
+
+  pumpa_.pump(graph_, order_, time_node_v_);
+
+  ++pumps_count_;
+
+  expire_retained_();
+}
+
+void engine::publish_async_results_()
+{
+  const auto p_first = input_queue::reverse(async_results_.take_all());
+
+  const std::unique_ptr<posted_input, void (*)(posted_input*)> guard(
+    p_first, &input_queue::destroy);
+
+  for (auto p = p_first; p; p = p->p_next)
+  {
+    // The node of an outdated result might not exist anymore
+    if (p->expired())
+      continue;
+
+    const auto v = converter::convert(p->id());
+
+    if (!p->apply(graph_[v].p_node))
+      continue;
+
+    if (is_active_node(v))
+      order_.mark(graph_[v].position);
+    else
+      discard_retained_value(v);
+  }
+}
+
+void engine::thaw_()
+{
+  ++structure_version_;
+
+  if (pumpa_.is_frozen())
+    freeze_delay_ = std::min(freeze_delay_ * 2, max_freeze_delay);
+
+  pumpa_.thaw(graph_, order_);
+}
+
+std::size_t engine::interned_key_(update_function p_type,
+                                  std::size_t hash,
+                                  const node_id* p_args,
+                                  std::size_t args_count)
+{
+  auto key = std::hash<update_function>()(p_type) ^ hash;
+
+  for (std::size_t i = 0; i < args_count; ++i)
+    key = key * 31 + std::hash<node_id>()(p_args[i]);
+
+  return key;
+}
+
+bool engine::is_retained_value_valid_(vertex_descriptor v,
+                                      std::size_t stamp) const
+{
+  CHECK_PRECONDITION(!is_active_node(v));
+
+  // An inactive vertex has no logical edge, so all its edges are data ones
+  for (auto es = out_edges(v, graph_); es.first != es.second; ++es.first)
+  {
+    if (graph_[target(*es.first, graph_)].changed_at > stamp)
+      return false;
+  }
+
+  return true;
+}
+
+void engine::expire_retained_()
+{
+  // The retained vertices are swept in rounds rather than after every pump,
+  // so a vertex lives between `retention_period_` and 1.5 times as many pumps
+  const auto sweep_period = std::max<std::size_t>(retention_period_ / 2, 1);
+
+  if (retained_.empty() || pumps_count_ - last_expiration_pump_ < sweep_period)
+    return;
+
+  last_expiration_pump_ = pumps_count_;
+
+  for (auto it = retained_.begin(); it != retained_.end();)
+  {
+    if (pumps_count_ - it->second.pump < retention_period_)
+    {
+      ++it;
+      continue;
+    }
+
+    deactivate_node_(it->first);
+
+    it = retained_.erase(it);
+  }
+}
+
 void engine::remove_subgraph_(vertex_descriptor v)
 {
   std::stack<vertex_descriptor> stack;
@@ -858,11 +1477,14 @@ void engine::remove_subgraph_(vertex_descriptor v)
 
     if (is_active_node(u))
     {
-      for (auto es = out_edges(u, graph_); es.first != es.second; ++es.first)
+      std::size_t idx = 0;
+
+      for (auto es = out_edges(u, graph_); es.first != es.second;
+           ++es.first, ++idx)
       {
         const auto e = *es.first;
         if (is_active_data_dependency(e))
-          deactivate_subgraph_(e);
+          deactivate_subgraph_(e, idx);
       }
 
       deactivate_vertex_(u);
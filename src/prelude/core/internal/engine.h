@@ -21,13 +21,18 @@
 #ifndef DATAFLOW___INTERNAL_ENGINE_H
 #define DATAFLOW___INTERNAL_ENGINE_H
 
+#include "async_pool.h"
 #include "converter.h"
 #include "discrete_time.h"
 #include "graph.h"
+#include "input_queue.h"
 #include "pumpa.h"
 
 #include <dataflow/prelude/core/engine_options.h>
 
+#include <functional>
+#include <memory>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -43,6 +48,8 @@ public:
 public:
   allocator_type get_allocator() const;
 
+  engine_options get_options() const;
+
   const dependency_graph& graph() const;
 
   const topological_list& order() const;
@@ -55,11 +62,30 @@ public:
   engine(const engine&) = delete;
   engine& operator=(const engine&) = delete;
 
-  static void start(void* p_data, engine_options options);
+  static void start(void* p_data,
+                    input_queue* p_inputs,
+                    engine_options options,
+                    std::size_t retention_period);
   static void stop();
 
   static engine& instance();
 
+  /// Makes `e` the engine of the calling thread while the object is alive.
+  /// This lets worker threads update nodes of the engine that employs them.
+  class thread_binding final
+  {
+  public:
+    explicit thread_binding(engine& e);
+    ~thread_binding();
+
+    thread_binding(const thread_binding&) = delete;
+    thread_binding& operator=(const thread_binding&) = delete;
+
+  private:
+    engine* const p_prev_;
+    const memory_context::scope memory_scope_;
+  };
+
   dtimestamp current_time() const;
 
   static void* data();
@@ -76,6 +102,9 @@ public:
 
   std::size_t changed_nodes_count() const;
   std::size_t updated_nodes_count() const;
+  std::size_t memory_consumption() const;
+
+  bool is_frozen() const;
 
   bool requires_activation(vertex_descriptor v) const;
 
@@ -85,27 +114,66 @@ public:
   vertex_descriptor get_time_node() const;
 
   vertex_descriptor add_node(node* p_node,
+                             update_function p_update,
                              const node_id* p_args,
                              std::size_t args_count,
                              bool eager,
                              bool conditional = false,
-                             bool pump = false);
+                             bool pump = false,
+                             bool concurrent = false,
+                             bool retainable = false);
 
   vertex_descriptor add_persistent_node(node* p_node);
 
+  // Hash-consing. The type of a node is identified by its update function,
+  // `p_equal` compares the node state with `p_value` (if not null).
+  vertex_descriptor
+  find_interned_node(update_function p_type,
+                     std::size_t hash,
+                     const node_id* p_args,
+                     std::size_t args_count,
+                     bool (*p_equal)(const node* p_node, const void* p_value),
+                     const void* p_value) const;
+
+  void intern_node(vertex_descriptor v,
+                   update_function p_type,
+                   std::size_t hash,
+                   const node_id* p_args,
+                   std::size_t args_count);
+
   void add_data_edge(vertex_descriptor u, vertex_descriptor v);
 
   void remove_data_edge(vertex_descriptor u, std::size_t idx);
 
   void schedule_and_pump(vertex_descriptor v);
 
+  // Schedules a variable or signal that has got a new value
+  void schedule_input(vertex_descriptor v);
+
+  // Runs `f` on another thread and queues its result, if any, to be
+  // published at the start of the next pump
+  void run_async(std::function<std::unique_ptr<posted_input>()> f);
+
+  // Publishes the results of the asynchronous calculations completed so far,
+  // pumping unless a transaction is open
+  void publish_async_results();
+
+  void start_transaction();
+  void commit_transaction();
+  // Closes the transaction without pumping, the scheduled vertices are left
+  // for the next pump
+  void abort_transaction();
+  bool is_in_transaction() const;
+
   void schedule_for_next_update(vertex_descriptor v);
 
+  void discard_retained_value(vertex_descriptor v);
+
   bool is_pumping() const;
 
-  void set_metadata(const node* p_node,
-                    std::shared_ptr<const metadata> p_metadata);
-  const std::shared_ptr<const metadata>& get_metadata(const node* p_node);
+  void* allocate_metadata(std::size_t size, std::size_t alignment);
+  void set_metadata(const node* p_node, const metadata* p_metadata, bool owned);
+  void forget_metadata(const node* p_node);
 
   update_status update_node_if_activator(vertex_descriptor v,
                                          bool initialized,
@@ -119,6 +187,12 @@ public:
   update_status update_node_snapshot_activator(vertex_descriptor v,
                                                bool initialized);
 
+  update_status update_node_state_machine_activator(vertex_descriptor v,
+                                                    bool initialized,
+                                                    std::size_t new_value,
+                                                    std::size_t old_value,
+                                                    bool restart);
+
   update_status update_node_since_activator(vertex_descriptor v,
                                             bool initialized,
                                             bool start_condition);
@@ -129,7 +203,10 @@ public:
   update_node_recursion_activator(vertex_descriptor v, bool initialized);
 
 private:
-  explicit engine(void* p_data, engine_options options);
+  explicit engine(void* p_data,
+                  input_queue* p_inputs,
+                  engine_options options,
+                  std::size_t retention_period);
   ~engine() noexcept;
 
   edge_descriptor out_edge_at_(vertex_descriptor v, std::size_t idx) const;
@@ -163,17 +240,70 @@ private:
 
   void reset_activator_(vertex_descriptor v, vertex_descriptor w);
 
-  void activate_edge_(edge_descriptor e);
+  // `idx` is the index of `e` among the out-edges of its source
+  void activate_edge_(edge_descriptor e, std::size_t idx);
+
+  void deactivate_edge_(edge_descriptor e, std::size_t idx);
+
+  // Deactivates the edge leaving the arguments of its source as they are
+  void release_edge_(edge_descriptor e);
 
-  void deactivate_edge_(edge_descriptor e);
+  // Rebuilds the arguments of `v` after its out-edges have been renumbered
+  void update_args_(vertex_descriptor v);
 
-  void activate_subgraph_(edge_descriptor e);
+  void activate_subgraph_(edge_descriptor e, std::size_t idx);
 
-  void deactivate_subgraph_(edge_descriptor e);
+  void deactivate_subgraph_(edge_descriptor e, std::size_t idx);
 
   void remove_subgraph_(vertex_descriptor v);
 
+  void pump_();
+
+  // Called before any change of the active graph structure
+  void thaw_();
+
+  void destroy_node_(node* p_node);
+
+  void forget_interned_(vertex_descriptor v);
+
+  // Calls `activate()`/`deactivate()` of the node and its fused stages
+  void activate_node_(vertex_descriptor v);
+  void deactivate_node_(vertex_descriptor v);
+
+  bool is_fusable_(vertex_descriptor v) const;
+
+  void fuse_chains_(vertex_descriptor v);
+
+  void fuse_chain_(vertex_descriptor v);
+
+  static std::size_t interned_key_(update_function p_type,
+                                   std::size_t hash,
+                                   const node_id* p_args,
+                                   std::size_t args_count);
+
+  bool is_retained_value_valid_(vertex_descriptor v, std::size_t stamp) const;
+
+  void expire_retained_();
+
+  void publish_async_results_();
+
+private:
+  struct interned_info
+  {
+    vertex_descriptor v;
+    update_function p_type;
+  };
+
+  struct retained_info
+  {
+    std::size_t stamp; // Change stamp at the moment of deactivation
+    std::size_t pump;  // Pump number at the moment of deactivation
+  };
+
 private:
+  // Outlives all the other members, which allocate from it
+  memory_context memory_;
+  const memory_context::scope memory_scope_;
   allocator_type allocator_;
   void* p_data_;
   const engine_options options_;
@@ -182,9 +312,70 @@ private:
   pumpa pumpa_;
   discrete_time ticks_;
   vertex_descriptor time_node_v_;
+  std::size_t transaction_depth_;
+
+  // Deactivated vertices keeping their values
+  const std::size_t retention_period_;
+  std::unordered_map<vertex_descriptor,
+                     retained_info,
+                     std::hash<vertex_descriptor>,
+                     std::equal_to<vertex_descriptor>,
+                     memory_allocator<std::pair<const vertex_descriptor,
+                                                retained_info>>>
+    retained_;
+  std::size_t pumps_count_;
+  std::size_t last_expiration_pump_;
+
+  // Number of structural changes, and its value at the start of the latest
+  // pump
+  std::size_t structure_version_;
+  std::size_t pumped_structure_version_;
+
+  // Consecutive pumps that kept the structure, and how many of them are
+  // needed to freeze the graph. The latter doubles whenever a frozen graph
+  // thaws, so that graphs changing often stop paying for the snapshots, and
+  // halves whenever a snapshot survives long enough, so that graphs which
+  // have settled get frozen quickly again.
+  std::size_t stable_pumps_count_;
+  std::size_t freeze_delay_;
+  std::size_t frozen_pumps_count_;
+
+  // Interned vertices by their hashes, and the other way round
+  std::unordered_multimap<std::size_t,
+                          interned_info,
+                          std::hash<std::size_t>,
+                          std::equal_to<std::size_t>,
+                          memory_allocator<std::pair<const std::size_t,
+                                                     interned_info>>>
+    interned_;
+  std::unordered_map<vertex_descriptor,
+                     std::size_t,
+                     std::hash<vertex_descriptor>,
+                     std::equal_to<vertex_descriptor>,
+                     memory_allocator<std::pair<const vertex_descriptor,
+                                                std::size_t>>>
+    interned_hashes_;
+
+  // Vertices that absorbed chains of their arguments
+  std::unordered_map<vertex_descriptor,
+                     fused_chain,
+                     std::hash<vertex_descriptor>,
+                     std::equal_to<vertex_descriptor>,
+                     memory_allocator<std::pair<const vertex_descriptor,
+                                                fused_chain>>>
+    fused_;
+
+  input_queue* const p_inputs_;
+
+  // Results of asynchronous calculations
+  input_queue async_results_;
+
+  // Goes first on destruction, so that no task outlives the engine
+  std::unique_ptr<async_pool> p_async_;
 
 private:
-  static engine* gp_engine_;
+  // Every thread runs its own engine, if any
+  static thread_local engine* gp_engine_;
 };
 } // internal
 } // dataflow
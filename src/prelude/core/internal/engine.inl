@@ -31,6 +31,11 @@ inline engine::allocator_type engine::get_allocator() const
   return allocator_;
 }
 
+inline engine_options engine::get_options() const
+{
+  return options_;
+}
+
 inline const dependency_graph& engine::graph() const
 {
   return graph_;
@@ -58,6 +63,18 @@ inline engine& engine::instance()
   return *gp_engine_;
 }
 
+inline engine::thread_binding::thread_binding(engine& e)
+: p_prev_(gp_engine_)
+, memory_scope_(e.memory_)
+{
+  gp_engine_ = &e;
+}
+
+inline engine::thread_binding::~thread_binding()
+{
+  gp_engine_ = p_prev_;
+}
+
 inline void* engine::data()
 {
   if (gp_engine_ != nullptr)
@@ -141,6 +158,16 @@ inline std::size_t engine::updated_nodes_count() const
   return pumpa_.updated_nodes_count();
 }
 
+inline std::size_t engine::memory_consumption() const
+{
+  return memory_.allocated();
+}
+
+inline bool engine::is_frozen() const
+{
+  return pumpa_.is_frozen();
+}
+
 inline bool engine::requires_activation(vertex_descriptor v) const
 {
   CHECK_PRECONDITION(v != vertex_descriptor());
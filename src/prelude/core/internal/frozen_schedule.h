@@ -0,0 +1,181 @@
+
+//  Copyright (c) 2014 - 2021 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include "config.h"
+#include "graph.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace dataflow
+{
+namespace internal
+{
+/// Snapshot of the active part of the dependency graph, which doesn't change
+/// its shape anymore.
+///
+/// Vertices are stored in their topological order along with compressed
+/// consumer lists (consumers of the vertex at index `i` are at
+/// `[consumer_offsets_[i], consumer_offsets_[i + 1])` of `consumers_`), and
+/// the vertices to be updated are marked in a bitset. Consumers always follow
+/// their dependencies, so a single forward scan over the bitset updates the
+/// vertices in a valid order.
+class frozen_schedule final
+{
+private:
+  using word = std::uint64_t;
+
+  static constexpr std::size_t word_bits = 64;
+
+public:
+  frozen_schedule(const dependency_graph& graph,
+                  const topological_list& order,
+                  const memory_allocator<char>& allocator)
+  : vertices_(allocator)
+  , consumer_offsets_(allocator)
+  , consumers_(allocator)
+  , marked_(allocator)
+  , indices_(allocator)
+  {
+    vertices_.reserve(order.size());
+    indices_.reserve(order.size());
+
+    for (const auto v : order)
+    {
+      indices_.emplace(v, vertices_.size());
+      vertices_.push_back(v);
+    }
+
+    consumer_offsets_.reserve(vertices_.size() + 1);
+
+    for (const auto v : vertices_)
+    {
+      consumer_offsets_.push_back(consumers_.size());
+
+      for (const auto u : graph[v].consumers)
+      {
+        CHECK_CONDITION(indices_.find(u) != indices_.end());
+
+        consumers_.push_back(indices_.find(u)->second);
+      }
+    }
+
+    consumer_offsets_.push_back(consumers_.size());
+
+    marked_.resize((vertices_.size() + word_bits - 1) / word_bits);
+  }
+
+  frozen_schedule(const frozen_schedule&) = delete;
+  frozen_schedule& operator=(const frozen_schedule&) = delete;
+
+  std::size_t size() const
+  {
+    return vertices_.size();
+  }
+
+  vertex_descriptor vertex_at(std::size_t idx) const
+  {
+    return vertices_[idx];
+  }
+
+  const std::size_t* consumers_begin(std::size_t idx) const
+  {
+    return consumers_.data() + consumer_offsets_[idx];
+  }
+
+  const std::size_t* consumers_end(std::size_t idx) const
+  {
+    return consumers_.data() + consumer_offsets_[idx + 1];
+  }
+
+  void mark(vertex_descriptor v)
+  {
+    const auto it = indices_.find(v);
+
+    CHECK_PRECONDITION(it != indices_.end());
+
+    mark(it->second);
+  }
+
+  void mark(std::size_t idx)
+  {
+    marked_[idx / word_bits] |= word(1) << (idx % word_bits);
+  }
+
+  void unmark(std::size_t idx)
+  {
+    marked_[idx / word_bits] &= ~(word(1) << (idx % word_bits));
+  }
+
+  /// Returns the index of the first marked vertex starting from `idx`, or
+  /// `size()` if there is none.
+  std::size_t next_marked(std::size_t idx) const
+  {
+    auto w = idx / word_bits;
+
+    if (w == marked_.size())
+      return size();
+
+    auto bits = marked_[w] & (~word(0) << (idx % word_bits));
+
+    while (bits == 0)
+    {
+      if (++w == marked_.size())
+        return size();
+
+      bits = marked_[w];
+    }
+
+    return w * word_bits + lowest_bit_(bits);
+  }
+
+private:
+  static std::size_t lowest_bit_(word bits)
+  {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, bits);
+    return idx;
+#else
+    return static_cast<std::size_t>(__builtin_ctzll(bits));
+#endif
+  }
+
+private:
+  std::vector<vertex_descriptor, memory_allocator<vertex_descriptor>>
+    vertices_;
+  std::vector<std::size_t, memory_allocator<std::size_t>> consumer_offsets_;
+  std::vector<std::size_t, memory_allocator<std::size_t>> consumers_;
+  std::vector<word, memory_allocator<word>> marked_;
+  std::unordered_map<vertex_descriptor,
+                     std::size_t,
+                     std::hash<vertex_descriptor>,
+                     std::equal_to<vertex_descriptor>,
+                     memory_allocator<std::pair<const vertex_descriptor,
+                                                std::size_t>>>
+    indices_;
+};
+} // internal
+} // dataflow
@@ -18,16 +18,13 @@
 
 #pragma once
 
+#include "arena_allocator.h"
 #include "config.h"
+#include "memory_context.h"
+#include "order_maintenance_list.h"
 
 #include <dataflow/prelude/core/internal/node.h>
 
-#include <dst/allocator/global_counter_allocator.h>
-#include <dst/binary_tree/list.h>
-#include <dst/binary_tree/mixin/avl.h>
-#include <dst/binary_tree/mixin/marking.h>
-#include <dst/binary_tree/mixin/ordering.h>
-
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/graph_traits.hpp>
 
@@ -39,9 +36,11 @@
 #endif
 
 #include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <list>
 #include <type_traits>
+#include <vector>
 
 #ifndef NDEBUG
 #include <unordered_set>
@@ -92,11 +91,18 @@ namespace internal
 {
 using vertex_descriptor = void*;
 
-template <typename T> using memory_allocator = dst::global_counter_allocator<T>;
+// Allocations are accounted in the memory context of the engine
+template <typename T> using memory_allocator = counting_allocator<T>;
+
+// Vertices and consumer links are allocated from arenas, so that the ones
+// created together are kept together and (de)activation of edges doesn't go
+// to the general-purpose allocator.
+template <typename T>
+using pooled_allocator = counting_allocator<T, arena_allocator<T>>;
 
 #ifdef DATAFLOW___EXPERIMENTAL_BUILD_WITH_BOOST_POOL_ALLOCATOR
 template <typename T>
-using list_element_allocator = dst::global_counter_allocator<
+using list_element_allocator = counting_allocator<
   T,
   boost::fast_pool_allocator<T,
                              boost::default_user_allocator_new_delete,
@@ -107,16 +113,17 @@ template <typename T> using list_element_allocator = memory_allocator<T>;
 #endif
 
 using topological_list =
-  dst::binary_tree::list<vertex_descriptor,
-                         list_element_allocator<vertex_descriptor>,
-                         dst::binary_tree::Marking<>,
-                         dst::binary_tree::AVL,
-                         dst::binary_tree::Ordering>;
+  order_maintenance_list<vertex_descriptor,
+                         list_element_allocator<vertex_descriptor>>;
 
 using topological_position = topological_list::const_iterator;
 
 using consumers_list =
-  std::list<vertex_descriptor, memory_allocator<vertex_descriptor>>;
+  std::list<vertex_descriptor, pooled_allocator<vertex_descriptor>>;
+
+using args_list = std::vector<const node*, memory_allocator<const node*>>;
+using arg_edges_list =
+  std::vector<std::uint32_t, memory_allocator<std::uint32_t>>;
 
 #if defined(_MSC_VER) && !defined(NDEBUG)
 class active_edge_ticket
@@ -157,30 +164,65 @@ private:
 using active_edge_ticket = consumers_list::const_iterator;
 #endif
 
+inline update_status update_node_virtually(node* p_node,
+                                           node_id id,
+                                           bool initialized,
+                                           const node** p_args,
+                                           std::size_t args_count)
+{
+  return p_node->update(id, initialized, p_args, args_count);
+}
+
+struct fused_stage
+{
+  node* p_node;
+  update_function p_update;
+};
+
+// Nodes absorbed by a vertex, in their update order
+struct fused_chain
+{
+  std::vector<fused_stage, memory_allocator<fused_stage>> stages;
+};
+
 class vertex final
 {
 private:
   using uint = std::size_t;
 
 public:
-  vertex(node* p_node)
+  vertex(node* p_node, update_function p_update = &update_node_virtually)
   : eager(false)
   , conditional(false)
   , constant(false)
   , straight(false)
   , initialized(false)
   , hidden(false)
+  , concurrent(false)
+  , retainable(false)
+  , warm(false)
   , ref_count_(0)
+  , changed_at(0)
   , position()
   , p_node(p_node)
+  , p_update(p_update)
+  , p_fused(nullptr)
+  , consumers()
+  , args()
+  , arg_edges()
   {
     assert(p_node);
 
     const auto expected_size = sizeof(uint) +          // Flags
                                sizeof(uint) +          // Reference counter
+                               sizeof(std::size_t) +   // Change stamp
                                sizeof(void*) +         // Topological position
                                sizeof(void*) +         // Node pointer
-                               sizeof(consumers_list); // Consumers list
+                               sizeof(void*) +         // Update function
+                               sizeof(void*) +         // Fused chain
+                               sizeof(consumers_list) + // Consumers list
+                               sizeof(args_list) +      // Active arguments
+                               sizeof(arg_edges_list);  // Their out-edges
 
     static_assert(sizeof(vertex) == expected_size,
                   "Vertex size must be kept small");
@@ -210,19 +252,55 @@ public:
   const uint straight : 1; // TODO: not used?
   uint initialized : 1;
   const uint hidden : 1; // TODO: not used?
+  uint concurrent : 1;
+  uint retainable : 1;
+  uint warm : 1; // Reactivated with its retained value still valid
 
 private:
   uint ref_count_;
 
 public:
+  std::size_t changed_at; // Change stamp of the latest value change
   topological_position position;
   node* const p_node;
+  update_function p_update;
+  const fused_chain* p_fused; // Nodes absorbed by the vertex, if any
   consumers_list consumers;
+  args_list args; // Nodes of active data dependencies, in out-edge order
+  arg_edges_list arg_edges; // Out-edge indices of `args`
 };
 
+inline update_status update_vertex(vertex& x, node_id id)
+{
+  const node** p_args = x.args.data();
+  std::size_t args_count = x.args.size();
+
+  if (x.p_fused)
+  {
+    const node* p_arg = nullptr;
+
+    for (const auto& stage : x.p_fused->stages)
+    {
+      const auto status =
+        stage.p_update(stage.p_node, id, x.initialized, p_args, args_count);
+
+      // The rest of the chain depends on this stage only
+      if (x.initialized &&
+          (status & update_status::updated) == update_status::nothing)
+        return update_status::nothing;
+
+      p_arg = stage.p_node;
+      p_args = &p_arg;
+      args_count = 1;
+    }
+  }
+
+  return x.p_update(x.p_node, id, x.initialized, p_args, args_count);
+}
+
 using dependency_graph_base =
   boost::adjacency_list<out_edge_listS<memory_allocator<void>>,
-                        vertex_listS<memory_allocator<void>>,
+                        vertex_listS<pooled_allocator<void>>,
                         boost::directedS,
                         vertex,
                         active_edge_ticket,
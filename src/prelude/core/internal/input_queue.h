@@ -0,0 +1,104 @@
+
+//  Copyright (c) 2014 - 2021 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <dataflow/prelude/core/internal/posted_input.h>
+
+#include <atomic>
+#include <memory>
+
+namespace dataflow
+{
+namespace internal
+{
+/// Multiple-producer single-consumer queue of posted inputs.
+///
+/// Producers push onto a lock-free stack, and the consumer takes the whole
+/// stack at once, so neither side ever waits for the other one.
+class input_queue final
+{
+public:
+  input_queue()
+  : p_head_(nullptr)
+  {
+  }
+
+  ~input_queue() noexcept
+  {
+    destroy(take_all());
+  }
+
+  input_queue(const input_queue&) = delete;
+  input_queue& operator=(const input_queue&) = delete;
+
+  void push(std::unique_ptr<posted_input> p_input)
+  {
+    const auto p = p_input.release();
+
+    p->p_next = p_head_.load(std::memory_order_relaxed);
+
+    while (!p_head_.compare_exchange_weak(
+      p->p_next, p, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+  }
+
+  bool empty() const
+  {
+    return p_head_.load(std::memory_order_relaxed) == nullptr;
+  }
+
+  /// Returns the inputs pushed so far, the latest one first.
+  posted_input* take_all()
+  {
+    return p_head_.exchange(nullptr, std::memory_order_acquire);
+  }
+
+  static posted_input* reverse(posted_input* p_first)
+  {
+    posted_input* p_reversed = nullptr;
+
+    while (p_first)
+    {
+      const auto p_next = p_first->p_next;
+
+      p_first->p_next = p_reversed;
+      p_reversed = p_first;
+      p_first = p_next;
+    }
+
+    return p_reversed;
+  }
+
+  static void destroy(posted_input* p_first)
+  {
+    while (p_first)
+    {
+      const auto p_next = p_first->p_next;
+
+      delete p_first;
+      p_first = p_next;
+    }
+  }
+
+private:
+  std::atomic<posted_input*> p_head_;
+};
+} // internal
+} // dataflow
@@ -0,0 +1,257 @@
+//  Copyright (c) 2014 - 2021 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace dataflow
+{
+namespace internal
+{
+namespace detail
+{
+/// Pool of fixed-size slots carved out of large chunks.
+///
+/// Freed slots are reused in LIFO order, and a fresh chunk hands out its slots
+/// in address order, so objects allocated together end up next to each other
+/// in memory. Chunks are kept until the arena is destroyed, which keeps all
+/// the addresses stable.
+class arena final
+{
+private:
+  static constexpr std::size_t slots_per_chunk = 256;
+
+public:
+  arena(std::size_t size, std::size_t alignment)
+  : size_(size)
+  , alignment_(alignment)
+  , slot_size_(slot_size_for_(size, alignment))
+  , p_free_(nullptr)
+  , chunks_()
+  {
+    // Chunks are only aligned as strictly as `new char[]` guarantees
+    assert(alignment <= alignof(std::max_align_t));
+  }
+
+  arena(const arena&) = delete;
+  arena& operator=(const arena&) = delete;
+
+  bool fits(std::size_t size, std::size_t alignment) const
+  {
+    return size_ == size && alignment_ == alignment;
+  }
+
+  void* allocate()
+  {
+    if (!p_free_)
+      grow_();
+
+    const auto p_slot = p_free_;
+
+    p_free_ = *static_cast<void**>(p_slot);
+
+    return p_slot;
+  }
+
+  void deallocate(void* p)
+  {
+    ::new (p) void*(p_free_);
+    p_free_ = p;
+  }
+
+private:
+  static std::size_t slot_size_for_(std::size_t size, std::size_t alignment)
+  {
+    const auto step = std::max(alignment, alignof(void*));
+
+    return (std::max(size, sizeof(void*)) + step - 1) / step * step;
+  }
+
+  void grow_()
+  {
+    chunks_.emplace_back(new char[slot_size_ * slots_per_chunk]);
+
+    const auto p_chunk = chunks_.back().get();
+
+    for (std::size_t i = slots_per_chunk; i-- > 0;)
+      deallocate(p_chunk + i * slot_size_);
+  }
+
+private:
+  const std::size_t size_;
+  const std::size_t alignment_;
+  const std::size_t slot_size_;
+  void* p_free_;
+  std::vector<std::unique_ptr<char[]>> chunks_;
+};
+} // detail
+
+/// Memory owned by an engine: the arenas its graph lives in, and the amount
+/// of memory allocated through its allocators.
+///
+/// Allocators take the current context of the calling thread when they are
+/// default-constructed, and keep it in their copies, so memory can be freed
+/// by any thread. The context is not synchronized, just like the engine.
+class memory_context final
+{
+public:
+  /// Makes the context current for the calling thread while the object is
+  /// alive.
+  class scope final
+  {
+  public:
+    explicit scope(memory_context& context)
+    : p_prev_(current_())
+    {
+      current_() = &context;
+    }
+
+    ~scope()
+    {
+      current_() = p_prev_;
+    }
+
+    scope(const scope&) = delete;
+    scope& operator=(const scope&) = delete;
+
+  private:
+    memory_context* const p_prev_;
+  };
+
+public:
+  memory_context()
+  : allocated_(0)
+  , arenas_()
+  {
+  }
+
+  memory_context(const memory_context&) = delete;
+  memory_context& operator=(const memory_context&) = delete;
+
+  static memory_context& current()
+  {
+    assert(current_() != nullptr);
+    return *current_();
+  }
+
+  std::size_t allocated() const
+  {
+    return allocated_;
+  }
+
+  void on_allocate(std::size_t size)
+  {
+    allocated_ += size;
+  }
+
+  void on_deallocate(std::size_t size)
+  {
+    allocated_ -= size;
+  }
+
+  detail::arena& get_arena(std::size_t size, std::size_t alignment)
+  {
+    // There are just a few distinct sizes, so a linear search is enough
+    for (const auto& p_arena : arenas_)
+    {
+      if (p_arena->fits(size, alignment))
+        return *p_arena;
+    }
+
+    arenas_.emplace_back(new detail::arena(size, alignment));
+
+    return *arenas_.back();
+  }
+
+private:
+  static memory_context*& current_()
+  {
+    static thread_local memory_context* p_current = nullptr;
+    return p_current;
+  }
+
+private:
+  std::size_t allocated_;
+  std::vector<std::unique_ptr<detail::arena>> arenas_;
+};
+
+/// Allocator accounting its allocations in a memory context.
+template <typename T, typename Base = std::allocator<T>>
+class counting_allocator : public Base
+{
+  template <typename U, typename B> friend class counting_allocator;
+
+public:
+  using value_type = T;
+
+  template <typename U> struct rebind
+  {
+    using other = counting_allocator<
+      U,
+      typename std::allocator_traits<Base>::template rebind_alloc<U>>;
+  };
+
+public:
+  counting_allocator()
+  : Base()
+  , p_context_(&memory_context::current())
+  {
+  }
+
+  template <typename U, typename B>
+  counting_allocator(const counting_allocator<U, B>& other)
+  : Base(static_cast<const B&>(other))
+  , p_context_(other.p_context_)
+  {
+  }
+
+  T* allocate(std::size_t n)
+  {
+    const auto p = Base::allocate(n);
+    p_context_->on_allocate(n * sizeof(T));
+    return p;
+  }
+
+  void deallocate(T* p, std::size_t n)
+  {
+    p_context_->on_deallocate(n * sizeof(T));
+    Base::deallocate(p, n);
+  }
+
+  template <typename U, typename B>
+  bool operator==(const counting_allocator<U, B>& other) const
+  {
+    return p_context_ == other.p_context_;
+  }
+
+  template <typename U, typename B>
+  bool operator!=(const counting_allocator<U, B>& other) const
+  {
+    return !(*this == other);
+  }
+
+private:
+  memory_context* p_context_;
+};
+} // internal
+} // dataflow
@@ -30,15 +30,16 @@ const discrete_time& node::ticks_()
   return engine::instance().ticks();
 }
 
-void node::set_metadata(const node* p_node,
-                        std::shared_ptr<const metadata> p_metadata)
+void* node::allocate_metadata_(std::size_t size, std::size_t alignment)
 {
-  engine::instance().set_metadata(p_node, std::move(p_metadata));
+  return engine::instance().allocate_metadata(size, alignment);
 }
 
-const std::shared_ptr<const metadata>& node::get_metadata(const node* p_node)
+void node::set_metadata_(const node* p_node,
+                         const metadata* p_metadata,
+                         bool owned)
 {
-  return engine::instance().get_metadata(p_node);
+  engine::instance().set_metadata(p_node, p_metadata, owned);
 }
 
 } // internal
@@ -0,0 +1,109 @@
+
+//  Copyright (c) 2014 - 2020 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+
+#include <dataflow/prelude/core/internal/node_state_machine_activator.h>
+#include <dataflow/prelude/core/internal/nodes_factory.h>
+
+#include "config.h"
+#include "engine.h"
+
+#include <utility>
+
+namespace dataflow
+{
+namespace internal
+{
+ref node_state_machine_activator::create(const ref* p_conditions,
+                                         std::size_t conditions_count,
+                                         std::vector<bool> restartable)
+{
+  CHECK_PRECONDITION(p_conditions != nullptr && conditions_count > 0);
+  CHECK_PRECONDITION(restartable.size() == conditions_count);
+
+  std::vector<node_id> args;
+
+  args.reserve(conditions_count);
+
+  for (std::size_t i = 0; i < conditions_count; ++i)
+  {
+    CHECK_PRECONDITION(p_conditions[i].is_of_type<bool>());
+
+    args.push_back(p_conditions[i].id());
+  }
+
+  return nodes_factory::create<node_state_machine_activator>(
+    args.data(), args.size(), node_flags::none, std::move(restartable));
+}
+
+node_state_machine_activator::node_state_machine_activator(
+  std::vector<bool> restartable)
+: node_t<std::size_t>(0)
+, restartable_(std::move(restartable))
+, selected_(restartable_.size())
+{
+}
+
+update_status node_state_machine_activator::update_(node_id id,
+                                                    bool initialized,
+                                                    const node** p_deps,
+                                                    std::size_t deps_count)
+{
+  CHECK_PRECONDITION(p_deps != nullptr && deps_count == restartable_.size());
+
+  const auto none = restartable_.size();
+
+  if (!initialized)
+  {
+    selected_ = none;
+
+    return engine::instance().update_node_state_machine_activator(
+             converter::convert(id), false, 0, 0, false) |
+           this->set_value_(0) | update_status::updated_next;
+  }
+
+  std::size_t selected = 0;
+
+  while (selected != none && !extract_node_value<bool>(p_deps[selected]))
+    ++selected;
+
+  const auto prev_selected = selected_;
+
+  selected_ = selected;
+
+  // A condition staying satisfied doesn't take its transition once more
+  if (selected == none || selected == prev_selected)
+    return update_status::nothing;
+
+  const auto new_value = selected + 1;
+
+  const auto result = engine::instance().update_node_state_machine_activator(
+    converter::convert(id),
+    true,
+    new_value,
+    this->value(),
+    restartable_[selected]);
+
+  return this->set_value_(new_value) | result;
+}
+
+std::string node_state_machine_activator::label_() const
+{
+  return "state-machine-activator";
+}
+} // internal
+} // dataflow
@@ -0,0 +1,37 @@
+
+//  Copyright (c) 2014 - 2020 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+#include <dataflow/prelude/core/internal/node_switch_activator.h>
+
+#include "engine.h"
+
+namespace dataflow
+{
+internal::update_status
+internal::update_node_switch_activator(node_id id,
+                                       bool initialized,
+                                       std::size_t new_alternative,
+                                       std::size_t old_alternative)
+{
+  // The alternatives of a switch are laid out the same way as the branches
+  // of `If()`, just there are more of them
+  return engine::instance().update_node_if_activator(converter::convert(id),
+                                                     initialized,
+                                                     new_alternative,
+                                                     old_alternative);
+}
+} // dataflow
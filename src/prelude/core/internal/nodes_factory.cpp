@@ -42,26 +42,32 @@ void nodes_factory::deallocate_(void* p_object,
 }
 
 ref nodes_factory::add_(node* p_node,
+                        update_function p_update,
                         const node_id* p_args,
                         std::size_t args_count,
                         node_flags flags)
 {
   return ref(converter::convert(engine::instance().add_node(
     p_node,
+    p_update,
     p_args,
     args_count,
     (flags & node_flags::eager) != node_flags::none,
     false,
-    (flags & node_flags::pump) != node_flags::none)));
+    (flags & node_flags::pump) != node_flags::none,
+    (flags & node_flags::concurrent) != node_flags::none,
+    (flags & node_flags::retainable) != node_flags::none)));
 }
 
 ref nodes_factory::add_conditional_(node* p_node,
+                                    update_function p_update,
                                     const node_id* p_args,
                                     std::size_t args_count,
                                     node_flags flags)
 {
   return ref(converter::convert(
     engine::instance().add_node(p_node,
+                                p_update,
                                 p_args,
                                 args_count,
                                 (flags & node_flags::eager) != node_flags::none,
@@ -74,6 +80,49 @@ ref nodes_factory::add_constant_(node* p_node)
     converter::convert(engine::instance().add_persistent_node(p_node)));
 }
 
+bool nodes_factory::is_foldable_constant(const ref& x)
+{
+  const auto& e = engine::instance();
+
+  return (e.get_options() & engine_options::constant_folding) !=
+           engine_options::nothing &&
+         e.is_persistent_node(converter::convert(x.id()));
+}
+
+bool nodes_factory::is_constant(const ref& x)
+{
+  return engine::instance().is_persistent_node(converter::convert(x.id()));
+}
+
+bool nodes_factory::find_interned_(update_function p_type,
+                                   std::size_t hash,
+                                   const node_id* p_args,
+                                   std::size_t args_count,
+                                   equal_function p_equal,
+                                   const void* p_value,
+                                   node_id& id)
+{
+  const auto v = engine::instance().find_interned_node(
+    p_type, hash, p_args, args_count, p_equal, p_value);
+
+  if (v == vertex_descriptor())
+    return false;
+
+  id = converter::convert(v);
+
+  return true;
+}
+
+void nodes_factory::intern_(node_id id,
+                            update_function p_type,
+                            std::size_t hash,
+                            const node_id* p_args,
+                            std::size_t args_count)
+{
+  engine::instance().intern_node(
+    converter::convert(id), p_type, hash, p_args, args_count);
+}
+
 ref nodes_factory::get_time_()
 {
   return ref(converter::convert(engine::instance().get_time_node()));
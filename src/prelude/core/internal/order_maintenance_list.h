@@ -0,0 +1,457 @@
+//  Copyright (c) 2014 - 2021 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "config.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace dataflow
+{
+namespace internal
+{
+/// Linked list answering "does `a` come before `b`" with a single integer
+/// comparison.
+///
+/// Every element carries a tag increasing along the list. An insertion takes
+/// the middle of the gap between the neighbours; when there is no gap left,
+/// the smallest aligned tag range around the insertion point whose density is
+/// low enough gets relabeled evenly (Bender et al., "Two Simplified Algorithms
+/// for Maintaining Order in a List"), which makes insertions amortized
+/// O(log n) relabels in the worst case and O(1) in the typical one.
+///
+/// Marked elements are kept in a separate binary heap ordered by tags, so that
+/// the first marked element is found in O(1). Relabeling preserves the order,
+/// thus it never invalidates the heap.
+template <typename T, typename Allocator> class order_maintenance_list final
+{
+private:
+  struct item
+  {
+    item* p_prev;
+    item* p_next;
+    std::uint64_t tag;
+    std::size_t heap_idx;
+    T value;
+  };
+
+  using item_allocator =
+    typename std::allocator_traits<Allocator>::template rebind_alloc<item>;
+  using heap_allocator =
+    typename std::allocator_traits<Allocator>::template rebind_alloc<item*>;
+
+  static constexpr std::uint64_t tags_count = std::uint64_t(1) << 62;
+  static constexpr std::size_t not_marked =
+    std::numeric_limits<std::size_t>::max();
+
+public:
+  class const_iterator final
+  {
+    friend class order_maintenance_list;
+
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+  public:
+    const_iterator()
+    : p_item_(nullptr)
+    {
+    }
+
+    reference operator*() const
+    {
+      return p_item_->value;
+    }
+
+    pointer operator->() const
+    {
+      return std::addressof(p_item_->value);
+    }
+
+    const_iterator& operator++()
+    {
+      p_item_ = p_item_->p_next;
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      const auto it = *this;
+      ++*this;
+      return it;
+    }
+
+    const_iterator& operator--()
+    {
+      p_item_ = p_item_->p_prev;
+      return *this;
+    }
+
+    const_iterator operator--(int)
+    {
+      const auto it = *this;
+      --*this;
+      return it;
+    }
+
+    bool operator==(const const_iterator& other) const
+    {
+      return p_item_ == other.p_item_;
+    }
+
+    bool operator!=(const const_iterator& other) const
+    {
+      return p_item_ != other.p_item_;
+    }
+
+  private:
+    explicit const_iterator(item* p_item)
+    : p_item_(p_item)
+    {
+    }
+
+  private:
+    item* p_item_;
+  };
+
+  using iterator = const_iterator;
+
+  class marked_iterator final
+  {
+    friend class order_maintenance_list;
+
+  public:
+    const T& operator*() const
+    {
+      return p_item_->value;
+    }
+
+    const_iterator base() const
+    {
+      return const_iterator(p_item_);
+    }
+
+    bool operator==(const marked_iterator& other) const
+    {
+      return p_item_ == other.p_item_;
+    }
+
+    bool operator!=(const marked_iterator& other) const
+    {
+      return p_item_ != other.p_item_;
+    }
+
+  private:
+    explicit marked_iterator(item* p_item)
+    : p_item_(p_item)
+    {
+    }
+
+  private:
+    item* p_item_;
+  };
+
+public:
+  order_maintenance_list()
+  : order_maintenance_list(Allocator())
+  {
+  }
+
+  explicit order_maintenance_list(const Allocator& allocator)
+  : allocator_(allocator)
+  , head_{&head_, &head_, 0, not_marked, T()}
+  , size_(0)
+  , marked_(heap_allocator(allocator))
+  {
+  }
+
+  ~order_maintenance_list() noexcept
+  {
+    for (auto p_item = head_.p_next; p_item != &head_;)
+    {
+      const auto p_next = p_item->p_next;
+      destroy_(p_item);
+      p_item = p_next;
+    }
+  }
+
+  order_maintenance_list(const order_maintenance_list&) = delete;
+  order_maintenance_list& operator=(const order_maintenance_list&) = delete;
+
+  const_iterator begin() const
+  {
+    return const_iterator(head_.p_next);
+  }
+
+  const_iterator end() const
+  {
+    return const_iterator(const_cast<item*>(&head_));
+  }
+
+  const T& front() const
+  {
+    CHECK_PRECONDITION(size_ > 0);
+
+    return head_.p_next->value;
+  }
+
+  std::size_t size() const
+  {
+    return size_;
+  }
+
+  /// Inserts `value` before `position`.
+  const_iterator insert(const_iterator position, const T& value)
+  {
+    const auto p_next = position.p_item_;
+    const auto p_prev = p_next->p_prev;
+
+    if (gap_after_(p_prev) < 2)
+      relabel_(p_prev);
+
+    const auto p_item = std::allocator_traits<item_allocator>::allocate(
+      allocator_, 1);
+
+    std::allocator_traits<item_allocator>::construct(
+      allocator_,
+      p_item,
+      item{p_prev, p_next, p_prev->tag + gap_after_(p_prev) / 2, not_marked,
+           value});
+
+    p_prev->p_next = p_item;
+    p_next->p_prev = p_item;
+
+    ++size_;
+
+    return const_iterator(p_item);
+  }
+
+  void erase(const_iterator position)
+  {
+    const auto p_item = position.p_item_;
+
+    CHECK_PRECONDITION(p_item != &head_);
+
+    unmark(position);
+
+    p_item->p_prev->p_next = p_item->p_next;
+    p_item->p_next->p_prev = p_item->p_prev;
+
+    --size_;
+
+    destroy_(p_item);
+  }
+
+  /// Returns `true` if `a` precedes `b`.
+  bool order(const_iterator a, const_iterator b) const
+  {
+    return a.p_item_->tag < b.p_item_->tag;
+  }
+
+  void mark(const_iterator position)
+  {
+    const auto p_item = position.p_item_;
+
+    if (p_item->heap_idx != not_marked)
+      return;
+
+    p_item->heap_idx = marked_.size();
+    marked_.push_back(p_item);
+
+    sift_up_(p_item->heap_idx);
+  }
+
+  void unmark(const_iterator position)
+  {
+    const auto p_item = position.p_item_;
+
+    if (p_item->heap_idx == not_marked)
+      return;
+
+    const auto idx = p_item->heap_idx;
+    const auto p_last = marked_.back();
+
+    marked_.pop_back();
+    p_item->heap_idx = not_marked;
+
+    if (p_last != p_item)
+    {
+      marked_[idx] = p_last;
+      p_last->heap_idx = idx;
+
+      sift_up_(idx);
+      sift_down_(p_last->heap_idx);
+    }
+  }
+
+  bool marked(const_iterator position) const
+  {
+    return position.p_item_->heap_idx != not_marked;
+  }
+
+  /// Returns the first marked element in the list order.
+  marked_iterator begin_marked() const
+  {
+    return marked_iterator(marked_.empty() ? nullptr : marked_.front());
+  }
+
+  marked_iterator end_marked() const
+  {
+    return marked_iterator(nullptr);
+  }
+
+private:
+  std::uint64_t gap_after_(const item* p_item) const
+  {
+    const auto next_tag =
+      p_item->p_next == &head_ ? tags_count : p_item->p_next->tag;
+
+    return next_tag - p_item->tag;
+  }
+
+  void relabel_(item* p_item)
+  {
+    // The head has tag 0 and takes part in relabeling as the first element
+    // of the range starting at 0, which keeps its tag intact.
+    static constexpr double overflow_threshold = 1.4;
+
+    auto p_lo = p_item;
+    auto p_hi = p_item;
+    std::size_t count = 1;
+    std::uint64_t range = 1;
+    double density = 1.0;
+
+    for (;;)
+    {
+      range <<= 1;
+      density /= overflow_threshold;
+
+      CHECK_CONDITION(range <= tags_count);
+
+      const auto base = p_item->tag & ~(range - 1);
+
+      while (p_lo != &head_ && p_lo->p_prev->tag >= base)
+      {
+        p_lo = p_lo->p_prev;
+        ++count;
+      }
+
+      while (p_hi->p_next != &head_ && p_hi->p_next->tag < base + range)
+      {
+        p_hi = p_hi->p_next;
+        ++count;
+      }
+
+      // One more slot is reserved for the element being inserted
+      const auto step = range / (count + 1);
+
+      if (step >= 2 && static_cast<double>(count + 1) <= density * range)
+      {
+        auto tag = base;
+
+        for (auto p = p_lo;; p = p->p_next)
+        {
+          p->tag = tag;
+          tag += step;
+
+          if (p == p_hi)
+            break;
+        }
+
+        return;
+      }
+    }
+  }
+
+  bool less_(std::size_t i, std::size_t j) const
+  {
+    return marked_[i]->tag < marked_[j]->tag;
+  }
+
+  void swap_(std::size_t i, std::size_t j)
+  {
+    std::swap(marked_[i], marked_[j]);
+    marked_[i]->heap_idx = i;
+    marked_[j]->heap_idx = j;
+  }
+
+  void sift_up_(std::size_t idx)
+  {
+    while (idx > 0)
+    {
+      const auto parent = (idx - 1) / 2;
+
+      if (!less_(idx, parent))
+        break;
+
+      swap_(idx, parent);
+      idx = parent;
+    }
+  }
+
+  void sift_down_(std::size_t idx)
+  {
+    for (;;)
+    {
+      const auto left = 2 * idx + 1;
+      const auto right = left + 1;
+      auto smallest = idx;
+
+      if (left < marked_.size() && less_(left, smallest))
+        smallest = left;
+      if (right < marked_.size() && less_(right, smallest))
+        smallest = right;
+
+      if (smallest == idx)
+        break;
+
+      swap_(idx, smallest);
+      idx = smallest;
+    }
+  }
+
+  void destroy_(item* p_item)
+  {
+    std::allocator_traits<item_allocator>::destroy(allocator_, p_item);
+    std::allocator_traits<item_allocator>::deallocate(allocator_, p_item, 1);
+  }
+
+private:
+  item_allocator allocator_;
+  item head_;
+  std::size_t size_;
+  std::vector<item*, heap_allocator> marked_;
+};
+
+template <typename T, typename Allocator>
+constexpr std::uint64_t order_maintenance_list<T, Allocator>::tags_count;
+
+template <typename T, typename Allocator>
+constexpr std::size_t order_maintenance_list<T, Allocator>::not_marked;
+} // internal
+} // dataflow
@@ -19,21 +19,39 @@
 #include "pumpa.h"
 
 #include "converter.h"
+#include "engine.h"
+
+#include <algorithm>
+#include <thread>
 
 namespace dataflow
 {
 namespace internal
 {
 pumpa::pumpa(const memory_allocator<char>& allocator, engine_options options)
-: options_(options)
+: allocator_(allocator)
+, options_(options)
 , pumping_started_(false)
-, args_buffer_(allocator)
 , next_update_(allocator)
-, metadata_(allocator)
-, p_no_metadata_(nullptr)
+, next_update_mutex_()
+, p_frozen_()
+, p_workers_()
+, batch_(allocator)
+, batch_status_(allocator)
+, metadata_arena_()
+, metadata_nodes_(allocator)
+, owned_metadata_(allocator)
 , changed_nodes_count_(0)
 , updated_nodes_count_(0)
+, change_stamp_(0)
 {
+  if ((options_ & engine_options::parallel_update) != engine_options::nothing)
+  {
+    const std::size_t threads_count = std::thread::hardware_concurrency();
+
+    p_workers_.reset(
+      new worker_pool(std::max<std::size_t>(threads_count, 2) - 1));
+  }
 }
 
 std::size_t pumpa::changed_nodes_count() const
@@ -50,30 +68,73 @@ std::size_t pumpa::updated_nodes_count() const
   return updated_nodes_count_;
 }
 
+std::size_t pumpa::change_stamp() const
+{
+  return change_stamp_;
+}
+
+std::size_t pumpa::new_change_stamp()
+{
+  return ++change_stamp_;
+}
+
 void pumpa::schedule_for_next_update(topological_position position)
 {
   CHECK_PRECONDITION(pumping_started_);
 
   if (position != topological_position())
+  {
+    // Can be called by concurrently updated nodes
+    std::lock_guard<std::mutex> lock(next_update_mutex_);
+
     next_update_.push_back(position);
+  }
+}
+
+void* pumpa::allocate_metadata(std::size_t size, std::size_t alignment)
+{
+  return metadata_arena_.allocate(size, alignment);
 }
 
 void pumpa::set_metadata(const node* p_node,
-                         std::shared_ptr<const metadata> p_metadata)
+                         const metadata* p_metadata,
+                         bool owned)
+{
+  CHECK_PRECONDITION(p_node != nullptr);
+  CHECK_CONDITION(p_node->p_metadata_ == nullptr);
+
+  if (owned)
+    owned_metadata_.push_back(p_metadata);
+
+  if (p_metadata)
+  {
+    p_node->p_metadata_ = p_metadata;
+    metadata_nodes_.push_back(p_node);
+  }
+}
+
+void pumpa::forget_metadata(const node* p_node)
 {
-  CHECK_CONDITION(metadata_.find(p_node) == metadata_.end());
+  if (p_node->p_metadata_ == nullptr)
+    return;
+
+  p_node->p_metadata_ = nullptr;
 
-  metadata_[p_node] = std::move(p_metadata);
+  metadata_nodes_.erase(
+    std::find(metadata_nodes_.begin(), metadata_nodes_.end(), p_node));
 }
 
-const std::shared_ptr<const metadata>& pumpa::get_metadata(const node* p_node)
+void pumpa::clear_metadata_()
 {
-  const auto it = metadata_.find(p_node);
+  for (const auto p_node : metadata_nodes_)
+    p_node->p_metadata_ = nullptr;
 
-  if (it == metadata_.end())
-    return p_no_metadata_;
+  for (const auto p_metadata : owned_metadata_)
+    p_metadata->~metadata();
 
-  return it->second;
+  metadata_nodes_.clear();
+  owned_metadata_.clear();
+  metadata_arena_.reset();
 }
 
 void pumpa::pump(dependency_graph& graph,
@@ -101,15 +162,16 @@ void pumpa::pump(dependency_graph& graph,
   catch (...)
   {
     pumping_started_ = false;
-    args_buffer_.clear();
-    metadata_.clear();
+    batch_.clear();
+    batch_status_.clear();
+    clear_metadata_();
     throw;
   }
 
   pumping_started_ = false;
 
   CHECK_POSTCONDITION(!pumping_started_);
-  CHECK_POSTCONDITION(metadata_.empty());
+  CHECK_POSTCONDITION(metadata_nodes_.empty());
 }
 
 bool pumpa::is_pumping() const
@@ -117,6 +179,34 @@ bool pumpa::is_pumping() const
   return pumping_started_;
 }
 
+void pumpa::freeze(const dependency_graph& graph, const topological_list& order)
+{
+  CHECK_PRECONDITION(!pumping_started_);
+
+  p_frozen_.reset(new frozen_schedule(graph, order, allocator_));
+}
+
+void pumpa::thaw(const dependency_graph& graph, topological_list& order)
+{
+  if (!p_frozen_)
+    return;
+
+  const auto& schedule = *p_frozen_;
+
+  for (auto idx = schedule.next_marked(0); idx != schedule.size();
+       idx = schedule.next_marked(idx + 1))
+  {
+    order.mark(graph[schedule.vertex_at(idx)].position);
+  }
+
+  p_frozen_.reset();
+}
+
+bool pumpa::is_frozen() const
+{
+  return p_frozen_ != nullptr;
+}
+
 void pumpa::pump_(dependency_graph& graph,
                   topological_list& order,
                   vertex_descriptor time_node_v)
@@ -132,14 +222,35 @@ void pumpa::pump_(dependency_graph& graph,
 
   order.mark(graph[time_node_v].position);
 
+  if (p_frozen_)
+    pump_frozen_(graph, order);
+
   std::vector<vertex_descriptor> queue;
 
   const auto to = order.end_marked();
   for (auto it = order.begin_marked(); it != to; it = order.begin_marked())
   {
-    order.unmark(it.base());
+    if (p_workers_ && graph[*it].concurrent)
+    {
+      collect_batch_(graph, order);
 
-    queue.push_back(*it);
+      if (batch_.size() > 1)
+      {
+        update_batch_(graph, order);
+
+        continue;
+      }
+
+      queue.push_back(batch_.front());
+
+      batch_.clear();
+    }
+    else
+    {
+      order.unmark(it.base());
+
+      queue.push_back(*it);
+    }
 
     while (!queue.empty())
     {
@@ -150,21 +261,17 @@ void pumpa::pump_(dependency_graph& graph,
 
       CHECK_CONDITION(p_node);
 
-      CHECK_CONDITION(args_buffer_.size() == 0);
-
-      for (auto es = out_edges(v, graph); es.first != es.second; ++es.first)
+      if (graph[v].warm)
       {
-        const auto e = *es.first;
+        graph[v].warm = false;
+        graph[v].initialized = true;
 
-        // Only active data dependencies get to the arguments list
-        if (is_active_data_dependency(e, graph))
-          args_buffer_.push_back(graph[target(e, graph)].p_node);
+        notify_consumers_(v, graph, order);
+
+        continue;
       }
 
-      const auto status = p_node->update(converter::convert(v),
-                                         graph[v].initialized,
-                                         args_buffer_.data(),
-                                         args_buffer_.size());
+      const auto status = update_vertex(graph[v], converter::convert(v));
 
       ++updated_nodes_count_;
 
@@ -175,14 +282,16 @@ void pumpa::pump_(dependency_graph& graph,
 
       graph[v].initialized = true;
 
-      args_buffer_.clear();
-
       if ((status & update_status::updated) != update_status::nothing)
       {
         ++changed_nodes_count_;
 
+        graph[v].changed_at = ++change_stamp_;
+
         for (const auto& u : graph[v].consumers)
         {
+          graph[u].warm = false;
+
           if ((options_ & engine_options::straight_update_optimization) !=
                 engine_options::nothing &&
               out_degree(u, graph) == 2 &&
@@ -202,7 +311,193 @@ void pumpa::pump_(dependency_graph& graph,
 
   CHECK_CONDITION(order.begin_marked() == order.end_marked());
 
-  metadata_.clear();
+  clear_metadata_();
+}
+
+void pumpa::pump_frozen_(dependency_graph& graph, topological_list& order)
+{
+  // The vertices marked since the previous pump (e.g. assigned variables)
+  // are moved to the snapshot
+  const auto to = order.end_marked();
+  for (auto it = order.begin_marked(); it != to; it = order.begin_marked())
+  {
+    p_frozen_->mark(*it);
+    order.unmark(it.base());
+  }
+
+  for (auto idx = p_frozen_->next_marked(0); idx != p_frozen_->size();
+       idx = p_frozen_->next_marked(idx))
+  {
+    p_frozen_->unmark(idx);
+
+    const auto v = p_frozen_->vertex_at(idx);
+    const auto p_node = graph[v].p_node;
+
+    // Vertices get warm only when activated, which thaws the graph
+    CHECK_CONDITION(p_node);
+    CHECK_CONDITION(!graph[v].warm);
+
+    const auto status = update_vertex(graph[v], converter::convert(v));
+
+    ++updated_nodes_count_;
+
+    if ((status & update_status::updated_next) != update_status::nothing)
+    {
+      schedule_for_next_update(graph[v].position);
+    }
+
+    graph[v].initialized = true;
+
+    // A structural change made by the update (e.g. by an activator) thaws
+    // the graph, the rest of the vertices are updated the regular way
+    if (!p_frozen_)
+    {
+      if ((status & update_status::updated) != update_status::nothing)
+      {
+        ++changed_nodes_count_;
+
+        graph[v].changed_at = ++change_stamp_;
+
+        for (const auto& u : graph[v].consumers)
+          order.mark(graph[u].position);
+      }
+
+      return;
+    }
+
+    if ((status & update_status::updated) != update_status::nothing)
+    {
+      ++changed_nodes_count_;
+
+      graph[v].changed_at = ++change_stamp_;
+
+      const auto to = p_frozen_->consumers_end(idx);
+      for (auto it = p_frozen_->consumers_begin(idx); it != to; ++it)
+        p_frozen_->mark(*it);
+    }
+  }
+}
+
+bool pumpa::is_independent_(vertex_descriptor v,
+                            topological_position first,
+                            const dependency_graph& graph,
+                            const topological_list& order) const
+{
+  if (!graph[v].concurrent)
+    return false;
+
+  // All the vertices preceding the first marked one are already up to date.
+  // Thus, a vertex whose active dependencies all precede it cannot be affected
+  // by any vertex that is still to be updated.
+  for (auto es = out_edges(v, graph); es.first != es.second; ++es.first)
+  {
+    const auto e = *es.first;
+
+    if (is_active_data_dependency(e, graph) &&
+        !order.order(graph[target(e, graph)].position, first))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void pumpa::collect_batch_(const dependency_graph& graph,
+                           topological_list& order)
+{
+  CHECK_PRECONDITION(batch_.empty());
+  CHECK_PRECONDITION(order.begin_marked() != order.end_marked());
+
+  const auto first = order.begin_marked().base();
+
+  const auto to = order.end_marked();
+  for (auto it = order.begin_marked(); it != to; it = order.begin_marked())
+  {
+    const auto v = *it;
+
+    // The batch is a prefix of the marked vertices, so that vertices which
+    // must be updated sequentially (e.g. activators) don't get overtaken.
+    if (!batch_.empty() && !is_independent_(v, first, graph, order))
+      break;
+
+    order.unmark(it.base());
+
+    batch_.push_back(v);
+  }
+
+  CHECK_POSTCONDITION(!batch_.empty());
+}
+
+void pumpa::update_batch_(dependency_graph& graph, topological_list& order)
+{
+  batch_status_.resize(batch_.size());
+
+  auto& e = engine::instance();
+
+  p_workers_->run(batch_.size(), [this, &graph, &e](std::size_t i) {
+    const engine::thread_binding binding(e);
+
+    const auto v = batch_[i];
+
+    if (graph[v].warm)
+      return;
+
+    batch_status_[i] = update_vertex(graph[v], converter::convert(v));
+  });
+
+  for (std::size_t i = 0; i < batch_.size(); ++i)
+  {
+    const auto v = batch_[i];
+
+    if (graph[v].warm)
+    {
+      graph[v].warm = false;
+      graph[v].initialized = true;
+
+      notify_consumers_(v, graph, order);
+
+      continue;
+    }
+
+    const auto status = batch_status_[i];
+
+    ++updated_nodes_count_;
+
+    if ((status & update_status::updated_next) != update_status::nothing)
+    {
+      schedule_for_next_update(graph[v].position);
+    }
+
+    graph[v].initialized = true;
+
+    if ((status & update_status::updated) != update_status::nothing)
+    {
+      ++changed_nodes_count_;
+
+      graph[v].changed_at = ++change_stamp_;
+
+      for (const auto& u : graph[v].consumers)
+      {
+        graph[u].warm = false;
+        order.mark(graph[u].position);
+      }
+    }
+  }
+
+  batch_.clear();
+  batch_status_.clear();
+}
+
+void pumpa::notify_consumers_(vertex_descriptor v,
+                              const dependency_graph& graph,
+                              topological_list& order)
+{
+  // A warm vertex reuses its retained value, which its consumers may not have
+  // seen yet. The value itself has not changed, so retained consumers stay
+  // warm.
+  for (const auto& u : graph[v].consumers)
+    order.mark(graph[u].position);
 }
 } // internal
 } // dataflow
@@ -18,13 +18,16 @@
 
 #pragma once
 
+#include "arena_allocator.h"
+#include "frozen_schedule.h"
 #include "graph.h"
 #include "node_time.h"
+#include "worker_pool.h"
 
 #include <dataflow/prelude/core/engine_options.h>
 
 #include <memory>
-#include <unordered_map>
+#include <mutex>
 #include <vector>
 
 namespace dataflow
@@ -40,11 +43,16 @@ public:
 
   std::size_t updated_nodes_count() const;
 
+  std::size_t change_stamp() const;
+
+  // Returns a stamp later than all the stamps issued so far
+  std::size_t new_change_stamp();
+
   void schedule_for_next_update(topological_position position);
 
-  void set_metadata(const node* p_node,
-                    std::shared_ptr<const metadata> p_metadata);
-  const std::shared_ptr<const metadata>& get_metadata(const node* p_node);
+  void* allocate_metadata(std::size_t size, std::size_t alignment);
+  void set_metadata(const node* p_node, const metadata* p_metadata, bool owned);
+  void forget_metadata(const node* p_node);
 
   void pump(dependency_graph& graph,
             topological_list& order,
@@ -52,33 +60,58 @@ public:
 
   bool is_pumping() const;
 
+  // While the graph is frozen, vertices are scheduled through the snapshot
+  // instead of the topological list. Thawing moves the pending marks back.
+  void freeze(const dependency_graph& graph, const topological_list& order);
+  void thaw(const dependency_graph& graph, topological_list& order);
+  bool is_frozen() const;
+
 private:
   void pump_(dependency_graph& graph,
              topological_list& order,
              vertex_descriptor time_node_v);
 
+  bool is_independent_(vertex_descriptor v,
+                       topological_position first,
+                       const dependency_graph& graph,
+                       const topological_list& order) const;
+
+  void pump_frozen_(dependency_graph& graph, topological_list& order);
+
+  void collect_batch_(const dependency_graph& graph, topological_list& order);
+
+  void update_batch_(dependency_graph& graph, topological_list& order);
+
+  void clear_metadata_();
+
+  void notify_consumers_(vertex_descriptor v,
+                         const dependency_graph& graph,
+                         topological_list& order);
+
 private:
+  const memory_allocator<char> allocator_;
   const engine_options options_;
   bool pumping_started_;
-  std::vector<const node*, memory_allocator<const node*>> args_buffer_;
   std::vector<topological_position, memory_allocator<topological_position>>
     next_update_;
+  std::mutex next_update_mutex_;
+
+  std::unique_ptr<frozen_schedule> p_frozen_;
 
-  // TODO: move to not existing yet `network` class together with graph and
-  //       topological order?
-  std::unordered_map<
-    const node*,
-    std::shared_ptr<const metadata>,
-    std::hash<const node*>,
-    std::equal_to<const node*>,
-    memory_allocator<
-      std::pair<const node* const, std::shared_ptr<const metadata>>>>
-    metadata_;
+  std::unique_ptr<worker_pool> p_workers_;
+  std::vector<vertex_descriptor, memory_allocator<vertex_descriptor>> batch_;
+  std::vector<update_status, memory_allocator<update_status>> batch_status_;
 
-  const std::shared_ptr<const metadata> p_no_metadata_;
+  // Nodes with metadata assigned and the metadata objects to be destroyed
+  // at the end of the pump iteration
+  monotonic_arena metadata_arena_;
+  std::vector<const node*, memory_allocator<const node*>> metadata_nodes_;
+  std::vector<const metadata*, memory_allocator<const metadata*>>
+    owned_metadata_;
 
   std::size_t changed_nodes_count_;
   std::size_t updated_nodes_count_;
+  std::size_t change_stamp_;
 };
 } // internal
 } // dataflow
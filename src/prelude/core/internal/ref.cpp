@@ -43,23 +43,25 @@ const node* ref::get_() const
 
 void ref::schedule_() const
 {
-  if (engine::instance().is_active_node(converter::convert(id_)))
-  {
-    if (engine::instance().is_pumping())
-    {
-      engine::instance().schedule_for_next_update(converter::convert(id_));
-    }
-    else
-    {
-      engine::instance().schedule_and_pump(converter::convert(id_));
-    }
-  }
+  engine::instance().schedule_input(converter::convert(id_));
 }
 
-void ref::set_metadata(std::shared_ptr<const metadata> p_metadata)
+void* ref::allocate_metadata_(std::size_t size, std::size_t alignment) const
 {
-  if (engine::instance().is_active_node(converter::convert(id_)))
-    engine::instance().set_metadata(get_(), std::move(p_metadata));
+  if (!engine::instance().is_active_node(converter::convert(id_)))
+    return nullptr;
+
+  return engine::instance().allocate_metadata(size, alignment);
+}
+
+void ref::set_metadata_(const metadata* p_metadata) const
+{
+  engine::instance().set_metadata(get_(), p_metadata, true);
+}
+
+void ref::reset_metadata_() const
+{
+  engine::instance().forget_metadata(get_());
 }
 
 void ref::reset_(const ref& other)
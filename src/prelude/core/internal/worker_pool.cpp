@@ -0,0 +1,178 @@
+
+//  Copyright (c) 2014 - 2021 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+
+#include "worker_pool.h"
+
+#include "config.h"
+
+#include <algorithm>
+
+namespace dataflow
+{
+namespace internal
+{
+worker_pool::worker_pool(std::size_t workers_count)
+: threads_()
+, mutex_()
+, start_cv_()
+, done_cv_()
+, generation_(0)
+, busy_count_(0)
+, stopping_(false)
+, p_task_(nullptr)
+, tasks_count_(0)
+, chunk_size_(1)
+, next_task_(0)
+, p_exception_()
+{
+  threads_.reserve(workers_count);
+
+  for (std::size_t i = 0; i < workers_count; ++i)
+    threads_.emplace_back([this]() { work_(); });
+}
+
+worker_pool::~worker_pool() noexcept
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    stopping_ = true;
+  }
+
+  start_cv_.notify_all();
+
+  for (auto& thread : threads_)
+    thread.join();
+}
+
+std::size_t worker_pool::workers_count() const
+{
+  return threads_.size();
+}
+
+void worker_pool::run(std::size_t tasks_count, const task_function& f)
+{
+  CHECK_PRECONDITION(p_task_ == nullptr);
+
+  if (tasks_count == 0)
+    return;
+
+  // Tasks are claimed in chunks by the calling thread and the workers alike;
+  // whoever runs out of work first simply claims the next chunk.
+  const auto threads_count = threads_.size() + 1;
+
+  if (threads_.empty() || tasks_count < 2 * threads_count)
+  {
+    for (std::size_t i = 0; i < tasks_count; ++i)
+      f(i);
+
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    p_task_ = &f;
+    tasks_count_ = tasks_count;
+    chunk_size_ = std::max<std::size_t>(1, tasks_count / (8 * threads_count));
+    next_task_.store(0, std::memory_order_relaxed);
+    busy_count_ = threads_.size();
+    ++generation_;
+  }
+
+  start_cv_.notify_all();
+
+  execute_();
+
+  std::exception_ptr p_exception;
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    done_cv_.wait(lock, [this]() { return busy_count_ == 0; });
+
+    p_task_ = nullptr;
+
+    std::swap(p_exception, p_exception_);
+  }
+
+  if (p_exception)
+    std::rethrow_exception(p_exception);
+}
+
+void worker_pool::work_()
+{
+  std::size_t generation = 0;
+
+  for (;;)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      start_cv_.wait(lock, [this, generation]() {
+        return stopping_ || generation_ != generation;
+      });
+
+      if (stopping_)
+        return;
+
+      generation = generation_;
+    }
+
+    execute_();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      if (--busy_count_ == 0)
+        done_cv_.notify_one();
+    }
+  }
+}
+
+void worker_pool::execute_()
+{
+  for (;;)
+  {
+    const auto first =
+      next_task_.fetch_add(chunk_size_, std::memory_order_relaxed);
+
+    if (first >= tasks_count_)
+      return;
+
+    const auto last = std::min(first + chunk_size_, tasks_count_);
+
+    try
+    {
+      for (auto i = first; i < last; ++i)
+        (*p_task_)(i);
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      if (!p_exception_)
+        p_exception_ = std::current_exception();
+
+      // Make the remaining tasks unreachable
+      next_task_.store(tasks_count_, std::memory_order_relaxed);
+    }
+  }
+}
+} // internal
+} // dataflow
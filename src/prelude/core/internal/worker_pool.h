@@ -0,0 +1,69 @@
+
+//  Copyright (c) 2014 - 2021 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dataflow
+{
+namespace internal
+{
+class worker_pool final
+{
+public:
+  using task_function = std::function<void(std::size_t)>;
+
+public:
+  explicit worker_pool(std::size_t workers_count);
+  ~worker_pool() noexcept;
+
+  worker_pool(const worker_pool&) = delete;
+  worker_pool& operator=(const worker_pool&) = delete;
+
+  std::size_t workers_count() const;
+
+  void run(std::size_t tasks_count, const task_function& f);
+
+private:
+  void work_();
+  void execute_();
+
+private:
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  std::size_t generation_;
+  std::size_t busy_count_;
+  bool stopping_;
+  const task_function* p_task_;
+  std::size_t tasks_count_;
+  std::size_t chunk_size_;
+  std::atomic<std::size_t> next_task_;
+  std::exception_ptr p_exception_;
+};
+} // internal
+} // dataflow
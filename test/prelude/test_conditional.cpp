@@ -137,6 +137,44 @@ BOOST_FIXTURE_TEST_CASE(test_Switch_string_string, test_fixture)
   BOOST_CHECK_EQUAL(*f, "nee");
 }
 
+BOOST_FIXTURE_TEST_CASE(test_Switch_variable_keys, test_fixture)
+{
+  auto x = Var(3);
+  auto k = Var(5);
+
+  auto f = Main(Switch(x,
+                       Case(1, 10),
+                       Case(2, 20),
+                       Case(3, 30),
+                       Case(k, 40),
+                       Case(5, 50),
+                       Default(0)));
+
+  BOOST_CHECK_EQUAL(*f, 30);
+
+  // Time, `x`, `k`, the activator, the switch and `Main()`. The constants
+  // are persistent nodes.
+  BOOST_CHECK_EQUAL(introspect::num_active_nodes(), 6);
+
+  // The first matching case wins
+  x = 5;
+
+  BOOST_CHECK_EQUAL(*f, 40);
+  BOOST_CHECK_EQUAL(introspect::num_updated_nodes(), 5);
+
+  k = 6;
+
+  BOOST_CHECK_EQUAL(*f, 50);
+
+  x = 6;
+
+  BOOST_CHECK_EQUAL(*f, 40);
+
+  x = 7;
+
+  BOOST_CHECK_EQUAL(*f, 0);
+}
+
 BOOST_FIXTURE_TEST_CASE(test_Switch_if_string, test_fixture)
 {
   auto x = Var<int>(1);
@@ -26,6 +26,12 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
 using namespace dataflow;
 
 namespace dataflow_test
@@ -112,6 +118,110 @@ private:
   std::shared_ptr<data> p_data_;
 };
 
+class copy_counter final
+{
+public:
+  explicit copy_counter(int value = 0)
+  : value_(value)
+  {
+  }
+
+  copy_counter(const copy_counter& other)
+  : value_(other.value_)
+  {
+    ++copies_count;
+  }
+
+  copy_counter(copy_counter&& other) = default;
+
+  copy_counter& operator=(const copy_counter& other)
+  {
+    value_ = other.value_;
+    ++copies_count;
+    return *this;
+  }
+
+  copy_counter& operator=(copy_counter&& other) = default;
+
+  int value() const
+  {
+    return value_;
+  }
+
+  bool operator==(const copy_counter& other) const
+  {
+    return value_ == other.value_;
+  }
+
+  bool operator!=(const copy_counter& other) const
+  {
+    return !(*this == other);
+  }
+
+  friend std::ostream& operator<<(std::ostream& out, const copy_counter& v)
+  {
+    out << v.value_;
+    return out;
+  }
+
+  static int copies_count;
+
+private:
+  int value_;
+};
+
+int copy_counter::copies_count = 0;
+
+// Each constructed value gets its own version, so that changes are detected
+// without comparing the values
+class versioned final
+{
+public:
+  explicit versioned(int value = 0)
+  : value_(value)
+  , version_(++last_version_)
+  {
+  }
+
+  int value() const
+  {
+    return value_;
+  }
+
+  bool identical(const versioned& other) const
+  {
+    return version_ == other.version_;
+  }
+
+  bool operator==(const versioned& other) const
+  {
+    ++comparisons_count;
+    return value_ == other.value_;
+  }
+
+  bool operator!=(const versioned& other) const
+  {
+    return !(*this == other);
+  }
+
+  friend std::ostream& operator<<(std::ostream& out, const versioned& v)
+  {
+    out << v.value_;
+    return out;
+  }
+
+  static int comparisons_count;
+
+private:
+  int value_;
+  int version_;
+
+  static int last_version_;
+};
+
+int versioned::comparisons_count = 0;
+int versioned::last_version_ = 0;
+
 template <typename T> box<T> make_box(const ref<T>& value)
 {
   return box<T>(value);
@@ -667,251 +777,1168 @@ BOOST_AUTO_TEST_CASE(test_Var_deferred_assign)
   BOOST_CHECK_EQUAL(*z, 200);
 }
 
-BOOST_AUTO_TEST_CASE(test_Cast_double_to_int)
+BOOST_AUTO_TEST_CASE(test_Transaction)
 {
   EngineTest engine;
 
-  auto x = Var(3.14);
-  const auto y = Cast<int>(x);
-  const auto m = Main(y);
-
-  BOOST_CHECK_EQUAL(*m, 3);
+  io_fixture io;
 
-  x = 2.17;
+  var<int> x = Var(1);
+  var<int> y = Var(2);
 
-  BOOST_CHECK_EQUAL(*m, 2);
+  const auto z = Main(introspect::Log(
+    core::Lift("add", x, y, [](int a, int b) { return a + b; }), "z"));
 
-  x = 4.99;
+  BOOST_CHECK_EQUAL(introspect::current_time(), 0);
+  BOOST_CHECK_EQUAL(*z, 3);
 
-  BOOST_CHECK_EQUAL(*m, 4);
-}
+  io.capture_output();
 
-BOOST_AUTO_TEST_CASE(test_Main_ref_arg)
-{
-  EngineTest engine;
+  {
+    Transaction tr;
 
-  const var<int> x = Var<int>(6);
+    x = 10;
+    y = 20;
 
-  BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(introspect::ref_count(x), 1);
+    BOOST_CHECK_EQUAL(introspect::current_time(), 0);
+    BOOST_CHECK_EQUAL(*z, 3);
+  }
 
-  const auto y = Main(x);
+  io.reset_output();
 
   BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(introspect::ref_count(x), 2);
-
-  BOOST_CHECK_EQUAL(introspect::label(y), "main");
-  BOOST_CHECK_EQUAL(*y, 6);
+  BOOST_CHECK_EQUAL(introspect::current_time(), 1);
+  BOOST_CHECK_EQUAL(*z, 30);
+  BOOST_CHECK_EQUAL(io.log_string(), "[t=1] z = 30;");
 }
 
-BOOST_AUTO_TEST_CASE(test_Main_init_func_arg)
+BOOST_AUTO_TEST_CASE(test_Transaction_nested)
 {
   EngineTest engine;
 
-  var<int> x = Var<int>(6);
-
-  const auto y = Main([x = x.as_ref()](dtime t) { return x; });
-
-  BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(*y, 6);
+  var<int> x = Var(1);
+  var<int> y = Var(100);
+  const sig s = Signal();
 
-  x = 25;
+  const auto z = Main(If(s, y, x));
 
-  BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(*y, 25);
-}
+  BOOST_CHECK_EQUAL(*z, 1);
 
-BOOST_AUTO_TEST_CASE(test_If_var_var_var)
-{
-  EngineTest engine;
+  {
+    Transaction tr1;
 
-  auto x = Var<bool>(true);
-  auto y = Var<int>(10);
-  auto z = Var<int>(20);
+    x = 2;
 
-  auto f = Main(If(x, y, z));
+    {
+      Transaction tr2;
 
-  BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(*f, 10);
+      s();
+    }
 
-  x = false;
+    BOOST_CHECK_EQUAL(introspect::current_time(), 0);
+    BOOST_CHECK_EQUAL(*z, 1);
+  }
 
   BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(*f, 20);
+  BOOST_CHECK_EQUAL(introspect::current_time(), 2);
+  BOOST_CHECK_EQUAL(*z, 2);
 }
 
-BOOST_AUTO_TEST_CASE(test_If_var_int_var)
+BOOST_AUTO_TEST_CASE(test_Transaction_no_changes)
 {
   EngineTest engine;
 
-  auto x = Var<bool>(true);
-  auto z = Var<int>(20);
+  var<int> x = Var(1);
 
-  auto f = Main(If(x, 10, z));
+  const auto z = Main(x);
 
-  BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(*f, 10);
+  {
+    Transaction tr;
 
-  x = false;
+    x = 1;
+  }
 
-  BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(*f, 20);
+  BOOST_CHECK_EQUAL(introspect::current_time(), 0);
+  BOOST_CHECK_EQUAL(*z, 1);
 }
 
-BOOST_AUTO_TEST_CASE(test_If_var_var_int)
+BOOST_AUTO_TEST_CASE(test_Transaction_exception)
 {
   EngineTest engine;
 
-  auto x = Var<bool>(true);
-  auto y = Var<int>(10);
+  var<int> x = Var(1);
 
-  auto f = Main(If(x, y, 20));
+  const auto z = Main(x);
 
-  BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(*f, 10);
+  try
+  {
+    Transaction tr;
 
-  x = false;
+    x = 10;
+
+    throw std::runtime_error("failure");
+  }
+  catch (const std::runtime_error&)
+  {
+  }
+
+  BOOST_CHECK_EQUAL(introspect::current_time(), 0);
+  BOOST_CHECK_EQUAL(*z, 1);
+
+  x = 20;
 
   BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(*f, 20);
+  BOOST_CHECK_EQUAL(introspect::current_time(), 1);
+  BOOST_CHECK_EQUAL(*z, 20);
 }
 
-BOOST_AUTO_TEST_CASE(test_If_var_int_int)
+BOOST_AUTO_TEST_CASE(test_parallel_update_fan_out)
 {
-  EngineTest engine;
+  Engine engine(engine_options::fully_optimized |
+                engine_options::parallel_update);
 
-  auto x = Var<bool>(true);
+  var<int> x = Var(1);
 
-  auto f = Main(If(x, 10, 20));
+  std::vector<ref<int>> ys;
 
-  BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(*f, 10);
+  for (int i = 0; i < 1000; ++i)
+    ys.push_back(core::Lift("mul", x, [i](int v) { return v * i; }));
 
-  x = false;
+  while (ys.size() > 1)
+  {
+    std::vector<ref<int>> zs;
 
-  BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(*f, 20);
-}
+    for (std::size_t i = 0; i + 1 < ys.size(); i += 2)
+      zs.push_back(
+        core::Lift("add", ys[i], ys[i + 1], [](int a, int b) { return a + b; }));
 
-BOOST_AUTO_TEST_CASE(test_If_var_str_strliteral)
-{
-  EngineTest engine;
+    if (ys.size() % 2 != 0)
+      zs.push_back(ys.back());
 
-  auto x = Var<bool>(true);
+    ys = std::move(zs);
+  }
 
-  auto f = Main(If(x, std::string("str"), "strliteral"));
+  const auto m = Main(ys.front());
 
   BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(*f, "str");
+  BOOST_CHECK_EQUAL(*m, 499500);
 
-  x = false;
+  x = 3;
 
   BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(*f, "strliteral");
+  BOOST_CHECK_EQUAL(introspect::current_time(), 1);
+  BOOST_CHECK_EQUAL(*m, 1498500);
+  BOOST_CHECK_EQUAL(introspect::num_updated_nodes(), 2002);
 }
 
-BOOST_AUTO_TEST_CASE(test_If_fn_fn)
+BOOST_AUTO_TEST_CASE(test_update_moves_values)
 {
   EngineTest engine;
 
-  auto x = Var<bool>(true);
-  auto y = Var<int>(11);
-  auto z = Var<int>(12);
+  auto x = Var(copy_counter(1));
+  auto y = core::Lift(
+    "incr", x, [](const copy_counter& v) { return copy_counter(v.value() + 1); });
+  const auto z = Main(y);
 
-  auto f = Main(If(
-    x,
-    [y = y.as_ref()](dtime t) { return y; },
-    [x = x.as_ref(), y = y.as_ref(), z = z.as_ref()](dtime t) {
-      return If(x, y, z);
-    }));
+  BOOST_CHECK_EQUAL((*z).value(), 2);
 
-  BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(introspect::active_node(y), true);
-  BOOST_CHECK_EQUAL(introspect::active_node(z), false);
-  BOOST_CHECK_EQUAL(*f, 11);
+  copy_counter::copies_count = 0;
 
-  y = 13;
+  x = copy_counter(5);
 
-  BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(*f, 13);
+  BOOST_CHECK_EQUAL((*z).value(), 6);
+  BOOST_CHECK_EQUAL(*x, copy_counter(5));
 
-  const auto count = introspect::num_active_nodes();
+  // Only the main node copies the value of its argument
+  BOOST_CHECK_EQUAL(copy_counter::copies_count, 1);
+}
 
-  x = false;
+BOOST_AUTO_TEST_CASE(test_identical_values)
+{
+  EngineTest engine;
 
-  BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(introspect::num_active_nodes(), count + 2);
-  BOOST_CHECK_EQUAL(introspect::active_node(y), false);
-  BOOST_CHECK_EQUAL(introspect::active_node(z), true);
-  BOOST_CHECK_EQUAL(*f, 12);
+  auto x = Var(versioned(1));
+  auto y = core::Lift(
+    "incr", x, [](const versioned& v) { return versioned(v.value() + 1); });
+  const auto z = Main(y);
 
-  z = 14;
+  BOOST_CHECK_EQUAL((*z).value(), 2);
 
-  BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(*f, 14);
+  versioned::comparisons_count = 0;
 
-  x = true;
+  x = versioned(1);
 
-  BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(introspect::num_active_nodes(), count);
-  BOOST_CHECK_EQUAL(introspect::active_node(y), true);
-  BOOST_CHECK_EQUAL(introspect::active_node(z), false);
-  BOOST_CHECK_EQUAL(*f, 13);
+  BOOST_CHECK_EQUAL(introspect::current_time(), 1);
+  BOOST_CHECK_EQUAL((*z).value(), 2);
+
+  x = versioned(5);
+
+  BOOST_CHECK_EQUAL(introspect::current_time(), 2);
+  BOOST_CHECK_EQUAL((*z).value(), 6);
+  BOOST_CHECK_EQUAL(versioned::comparisons_count, 0);
 }
 
-BOOST_AUTO_TEST_CASE(test_If_ref_fn)
+BOOST_AUTO_TEST_CASE(test_LiftMemo)
 {
   EngineTest engine;
 
-  auto x = Var<bool>(true);
-  auto y = Var<int>(11);
-  auto z = Var<int>(12);
+  auto x = Var<int>(1);
 
-  auto f = Main(If(x, y, [z = z.as_ref()](dtime t0) { return z; }));
+  int calls = 0;
 
-  BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(introspect::active_node(y), true);
-  BOOST_CHECK_EQUAL(introspect::active_node(z), false);
-  BOOST_CHECK_EQUAL(*f, 11);
+  const auto y = core::LiftMemo("square", x, [&calls](int v) {
+    ++calls;
+    return v * v;
+  });
+  const auto z = Main(y);
 
-  y = 34;
+  BOOST_CHECK_EQUAL(*z, 1);
+  BOOST_CHECK_EQUAL(calls, 1);
 
-  BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(*f, 34);
+  x = 2;
+  x = 1;
+  x = 2;
 
-  x = false;
+  BOOST_CHECK_EQUAL(*z, 4);
+  BOOST_CHECK_EQUAL(calls, 2);
 
-  BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(introspect::active_node(y), false);
-  BOOST_CHECK_EQUAL(introspect::active_node(z), true);
-  BOOST_CHECK_EQUAL(*f, 12);
+  for (int i = 3; i < 12; ++i)
+    x = i;
 
-  z = 15;
+  BOOST_CHECK_EQUAL(*z, 121);
+  BOOST_CHECK_EQUAL(calls, 11);
 
-  BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(*f, 15);
+  // The oldest results are evicted
+  x = 1;
+
+  BOOST_CHECK_EQUAL(*z, 1);
+  BOOST_CHECK_EQUAL(calls, 12);
 }
 
-BOOST_AUTO_TEST_CASE(test_If_fn_ref)
+BOOST_AUTO_TEST_CASE(test_LiftMemo_deactivation)
 {
-  EngineTest engine;
+  Engine engine;
 
-  auto x = Var<bool>(true);
-  auto y = Var<int>(11);
-  auto z = Var<int>(12);
+  auto x = Var<int>(1);
+  auto b = Var<bool>(true);
 
-  auto f = Main(If(
-    x, [y = y.as_ref()](dtime t0) { return y; }, z));
+  int calls = 0;
 
-  BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(introspect::active_node(y), true);
-  BOOST_CHECK_EQUAL(introspect::active_node(z), false);
-  BOOST_CHECK_EQUAL(*f, 11);
+  const auto y = core::LiftMemo("square", x, [&calls](int v) {
+    ++calls;
+    return v * v;
+  });
+  const auto z = Main(If(b, y, Const(-1)));
 
-  y = 34;
+  x = 2;
 
-  BOOST_CHECK(graph_invariant_holds());
-  BOOST_CHECK_EQUAL(*f, 34);
+  BOOST_CHECK_EQUAL(*z, 4);
+  BOOST_CHECK_EQUAL(calls, 2);
+
+  // The cache is dropped along with the value
+  b = false;
+  b = true;
+
+  BOOST_CHECK_EQUAL(*z, 4);
+  BOOST_CHECK_EQUAL(calls, 3);
+
+  x = 1;
+
+  BOOST_CHECK_EQUAL(*z, 1);
+  BOOST_CHECK_EQUAL(calls, 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_hash_consing)
+{
+  Engine engine(engine_options::fully_optimized |
+                engine_options::hash_consing);
+
+  struct policy
+  {
+    static std::string label()
+    {
+      return "add";
+    }
+    int calculate(int a, int b)
+    {
+      return a + b;
+    }
+  };
+
+  auto x = Var<int>(1);
+
+  const auto n = introspect::num_vertices();
+
+  const auto a = core::Lift<policy>(x, Const(2));
+  const auto b = core::Lift<policy>(x, Const(2));
+
+  BOOST_CHECK_EQUAL(introspect::num_vertices(), n + 2);
+
+  const auto c = core::Lift<policy>(Const(2), x);
+
+  BOOST_CHECK_EQUAL(introspect::num_vertices(), n + 3);
+
+  const auto m = Main(core::Lift<policy>(a, core::Lift<policy>(b, c)));
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*m, 9);
+
+  x = 2;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*m, 12);
+}
+
+BOOST_AUTO_TEST_CASE(test_hash_consing_signed_zero)
+{
+  Engine engine(engine_options::fully_optimized |
+                engine_options::hash_consing);
+
+  const auto inverse = [](double v) { return 1.0 / v; };
+
+  const auto a = Main(core::Lift("inverse", Const(0.0), inverse));
+  const auto b = Main(core::Lift("inverse", Const(-0.0), inverse));
+
+  BOOST_CHECK_GT(*a, 0.0);
+  BOOST_CHECK_LT(*b, 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_constant_folding)
+{
+  Engine engine(engine_options::fully_optimized |
+                engine_options::constant_folding);
+
+  struct policy
+  {
+    static std::string label()
+    {
+      return "add";
+    }
+    int calculate(int a, int b)
+    {
+      return a + b;
+    }
+  };
+
+  const auto x = core::Lift<policy>(Const(1), Const(2));
+  const auto y = core::Lift<policy>(x, Const(3));
+
+  BOOST_CHECK_EQUAL(introspect::label(y), "const");
+  BOOST_CHECK(introspect::persistent_node(y));
+
+  auto z = Var<int>(4);
+
+  const auto m = Main(core::Lift<policy>(y, z));
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*m, 10);
+  BOOST_CHECK_EQUAL(introspect::num_active_nodes(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_chain_fusion)
+{
+  Engine engine(engine_options::fully_optimized |
+                engine_options::chain_fusion);
+
+  auto x = Var<int>(1);
+
+  struct chain
+  {
+    static ref<int> of(const ref<int>& a, int n)
+    {
+      const auto b = core::Lift("incr", a, [](int v) { return v + 1; });
+      return n > 1 ? of(b, n - 1) : b;
+    }
+  };
+
+  const auto y = chain::of(x, 100);
+  const auto z = chain::of(y, 100);
+  const auto m = Main(core::Lift(
+    "add", y, z, [](int a, int b) { return a + b; }));
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*m, 302);
+
+  // `y` and `z` are used by other nodes, the rest is fused into them
+  BOOST_CHECK_EQUAL(introspect::num_active_nodes(), 6);
+
+  x = 2;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*m, 304);
+  BOOST_CHECK_EQUAL(introspect::num_updated_nodes(), 6);
+}
+
+BOOST_AUTO_TEST_CASE(test_frozen_graph)
+{
+  Engine engine(engine_options::fully_optimized |
+                engine_options::frozen_graph);
+
+  auto x = Var<int>(1);
+  auto c = Var<bool>(true);
+
+  const auto m =
+    Main(If(c,
+            core::Lift("incr", x, [](int v) { return v + 1; }),
+            core::Lift("mult", x, [](int v) { return v * 10; })));
+
+  BOOST_CHECK_EQUAL(*m, 2);
+  BOOST_CHECK(!introspect::is_graph_frozen());
+
+  // The branch has been activated during the first pump
+  x = 2;
+
+  BOOST_CHECK(!introspect::is_graph_frozen());
+  BOOST_CHECK_EQUAL(*m, 3);
+
+  x = 3;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK(introspect::is_graph_frozen());
+  BOOST_CHECK_EQUAL(*m, 4);
+  BOOST_CHECK_EQUAL(introspect::num_updated_nodes(), 5);
+
+  c = false;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK(!introspect::is_graph_frozen());
+  BOOST_CHECK_EQUAL(*m, 30);
+
+  x = 4;
+
+  BOOST_CHECK(!introspect::is_graph_frozen());
+  BOOST_CHECK_EQUAL(*m, 40);
+
+  // The graph has thawed once, so it needs two stable pumps to freeze again
+  x = 5;
+
+  BOOST_CHECK(!introspect::is_graph_frozen());
+  BOOST_CHECK_EQUAL(*m, 50);
+
+  x = 6;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK(introspect::is_graph_frozen());
+  BOOST_CHECK_EQUAL(*m, 60);
+}
+
+BOOST_AUTO_TEST_CASE(test_frozen_graph_backoff)
+{
+  Engine engine(engine_options::fully_optimized |
+                engine_options::frozen_graph);
+
+  auto x = Var<int>(1);
+  auto c = Var<bool>(true);
+
+  const auto m =
+    Main(If(c,
+            core::Lift("incr", x, [](int v) { return v + 1; }),
+            core::Lift("mult", x, [](int v) { return v * 10; })));
+
+  const auto stable_pumps_to_freeze = [&]() {
+    int n = 0;
+
+    while (!introspect::is_graph_frozen())
+    {
+      x = *x + 1;
+      ++n;
+    }
+
+    return n;
+  };
+
+  // The first pump activates the branch
+  BOOST_CHECK_EQUAL(stable_pumps_to_freeze(), 2);
+
+  // A graph switching its structure back and forth waits longer and longer
+  for (int delay = 2; delay <= 64; delay *= 2)
+  {
+    c = !*c;
+
+    BOOST_CHECK(!introspect::is_graph_frozen());
+    BOOST_CHECK_EQUAL(stable_pumps_to_freeze(), delay + 1);
+  }
+
+  c = !*c;
+
+  BOOST_CHECK_EQUAL(stable_pumps_to_freeze(), 65);
+  BOOST_CHECK(graph_invariant_holds());
+}
+
+BOOST_AUTO_TEST_CASE(test_frozen_graph_settles)
+{
+  Engine engine(engine_options::fully_optimized |
+                engine_options::frozen_graph);
+
+  auto x = Var<int>(1);
+  auto c = Var<bool>(true);
+
+  const auto m =
+    Main(If(c,
+            core::Lift("incr", x, [](int v) { return v + 1; }),
+            core::Lift("mult", x, [](int v) { return v * 10; })));
+
+  const auto stable_pumps_to_freeze = [&]() {
+    int n = 0;
+
+    while (!introspect::is_graph_frozen())
+    {
+      x = *x + 1;
+      ++n;
+    }
+
+    return n;
+  };
+
+  BOOST_CHECK_EQUAL(stable_pumps_to_freeze(), 2);
+
+  // The structure changes a few times during startup
+  for (int delay = 2; delay <= 8; delay *= 2)
+  {
+    c = !*c;
+
+    BOOST_CHECK_EQUAL(stable_pumps_to_freeze(), delay + 1);
+  }
+
+  // Every 64 pumps the snapshot survives halve the delay back to one
+  for (int i = 0; i < 3 * 64; ++i)
+    x = *x + 1;
+
+  BOOST_CHECK(introspect::is_graph_frozen());
+
+  c = !*c;
+
+  BOOST_CHECK(!introspect::is_graph_frozen());
+  BOOST_CHECK_EQUAL(stable_pumps_to_freeze(), 3);
+  BOOST_CHECK(graph_invariant_holds());
+}
+
+BOOST_AUTO_TEST_CASE(test_engines_per_thread)
+{
+  Engine engine;
+
+  auto x = Var<int>(1);
+
+  const auto m = Main(core::Lift("incr", x, [](int v) { return v + 1; }));
+
+  std::vector<int> results(4);
+  std::vector<std::thread> threads;
+
+  for (std::size_t i = 0; i < results.size(); ++i)
+  {
+    threads.emplace_back([i, &results]() {
+      Engine engine;
+
+      auto y = Var<int>(0);
+
+      const auto n = Main(core::Lift(
+        "shift", y, [i](int v) { return v * 2 + static_cast<int>(i); }));
+
+      for (int k = 1; k <= 100; ++k)
+        y = k;
+
+      results[i] = *n;
+    });
+  }
+
+  x = 2;
+
+  for (auto& t : threads)
+    t.join();
+
+  BOOST_CHECK_EQUAL(*m, 3);
+
+  for (std::size_t i = 0; i < results.size(); ++i)
+    BOOST_CHECK_EQUAL(results[i], 200 + static_cast<int>(i));
+}
+
+BOOST_AUTO_TEST_CASE(test_memory_consumption_per_engine)
+{
+  Engine engine;
+
+  auto x = Var<int>(1);
+
+  const auto consumption = introspect::memory_consumption();
+
+  BOOST_CHECK(consumption > 0);
+
+  std::size_t other_consumption = 0;
+
+  std::thread([&other_consumption]() {
+    Engine engine;
+
+    std::vector<var<int>> vars;
+
+    for (int i = 0; i < 1000; ++i)
+      vars.push_back(Var<int>(i));
+
+    other_consumption = introspect::memory_consumption();
+  }).join();
+
+  BOOST_CHECK(other_consumption > consumption);
+  BOOST_CHECK_EQUAL(introspect::memory_consumption(), consumption);
+}
+
+BOOST_AUTO_TEST_CASE(test_Post_Drain)
+{
+  Engine engine;
+
+  auto x = Var<int>(0);
+  auto y = Var<int>(0);
+
+  // Without conflation every posted value is seen, in the posting order
+  int updates = 0;
+  int skipped = 0;
+  int last_x = 0;
+  int last_y = 0;
+
+  const auto m = Main(core::Lift("add", x, y, [&](int a, int b) {
+    if (a != last_x && a != last_x + 1)
+      ++skipped;
+    if (b != last_y && b != last_y - 1)
+      ++skipped;
+
+    last_x = a;
+    last_y = b;
+    ++updates;
+
+    return a + b;
+  }));
+
+  std::thread tx([&]() {
+    for (int k = 1; k <= 1000; ++k)
+      engine.Post(x, k);
+  });
+  std::thread ty([&]() {
+    for (int k = 1; k <= 1000; ++k)
+      engine.Post(y, -k);
+  });
+
+  tx.join();
+  ty.join();
+
+  BOOST_CHECK_EQUAL(*m, 0);
+  BOOST_CHECK_EQUAL(introspect::current_time(), 0);
+
+  engine.Drain();
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*x, 1000);
+  BOOST_CHECK_EQUAL(*y, -1000);
+  BOOST_CHECK_EQUAL(*m, 0);
+  BOOST_CHECK_EQUAL(introspect::current_time(), 2000);
+  BOOST_CHECK_EQUAL(updates, 2001);
+  BOOST_CHECK_EQUAL(skipped, 0);
+
+  engine.Drain();
+
+  BOOST_CHECK_EQUAL(introspect::current_time(), 2000);
+}
+
+BOOST_AUTO_TEST_CASE(test_Post_Drain_conflation)
+{
+  Engine engine(engine_options::fully_optimized |
+                engine_options::input_conflation);
+
+  io_fixture io;
+
+  auto x = Var<int>(0);
+  const sig s = Signal();
+
+  io.capture_output();
+
+  const auto m = Main(introspect::Log(x, "x"));
+  const auto n = Main(introspect::Log(s, "s"));
+
+  for (int k = 1; k <= 1000; ++k)
+    engine.Post(x, k);
+
+  engine.Post(s);
+  engine.Post(x, 7);
+  engine.Drain();
+
+  io.reset_output();
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*m, 7);
+  BOOST_CHECK_EQUAL(io.log_string(),
+                    "[t=0] x = 0;[t=1] s = false;[t=2] x = 7;[t=2] s = true;"
+                    "[t=3] s = false;");
+}
+
+BOOST_AUTO_TEST_CASE(test_LiftAsync)
+{
+  Engine engine;
+
+  io_fixture io;
+
+  auto x = Var<int>(1);
+
+  struct policy
+  {
+    static std::string label()
+    {
+      return "slow";
+    }
+
+    int calculate(int v) const
+    {
+      // Makes sure the calculation gets outdated before it is done
+      std::this_thread::sleep_for(std::chrono::milliseconds(v == 2 ? 100 : 1));
+
+      return v * 10;
+    }
+  };
+
+  const auto drain_until = [&](const ref<int>& y, int value) {
+    for (int i = 0; i < 10000 && y.value<int>() != value; ++i)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+      engine.Drain();
+    }
+  };
+
+  io.capture_output();
+
+  const auto y = core::LiftAsync<policy>(x);
+  const auto m = Main(introspect::Log(y, "y"));
+
+  drain_until(y, 10);
+
+  // The calculation for 2 is cancelled by the one for 3
+  x = 2;
+  x = 3;
+
+  drain_until(y, 30);
+
+  io.reset_output();
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*m, 30);
+  BOOST_CHECK_EQUAL(io.log_string(), "[t=0] y = 0;[t=1] y = 10;[t=4] y = 30;");
+}
+
+BOOST_AUTO_TEST_CASE(test_LiftAsync_published_by_pump)
+{
+  Engine engine;
+
+  auto x = Var<int>(1);
+  auto z = Var<int>(0);
+
+  struct policy
+  {
+    static std::string label()
+    {
+      return "slow";
+    }
+
+    int calculate(int v) const
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+      return v * 10;
+    }
+  };
+
+  const auto y = core::LiftAsync<policy>(x);
+  const auto m =
+    Main(core::Lift("add", y, z, [](int a, int b) { return a + b; }));
+
+  // Any update publishes the completed calculations, `Drain()` is not needed
+  for (int i = 1; i <= 10000 && *m < 10; ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    z = i;
+  }
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(y.value<int>(), 10);
+  BOOST_CHECK_EQUAL(*m, 10 + *z);
+}
+
+BOOST_AUTO_TEST_CASE(test_Publish)
+{
+  Engine engine;
+
+  auto x = Var<int>(1);
+
+  const auto p = Publish(
+    core::Lift("str", x, [](int v) { return std::string(v, 'a'); }));
+  const auto reader = p.reader();
+
+  BOOST_CHECK_EQUAL(*p, "a");
+  BOOST_CHECK_EQUAL(reader.load(), "a");
+
+  std::atomic<bool> done(false);
+  bool ordered = true;
+  std::size_t last_size = 0;
+
+  std::thread t([reader, &done, &ordered, &last_size]() {
+    while (!done)
+    {
+      const auto v = reader.load();
+
+      if (v.size() < last_size || v != std::string(v.size(), 'a'))
+        ordered = false;
+
+      last_size = v.size();
+    }
+  });
+
+  for (int k = 2; k <= 500; ++k)
+    x = k;
+
+  done = true;
+  t.join();
+
+  BOOST_CHECK(ordered);
+  BOOST_CHECK_EQUAL(reader.load(), std::string(500, 'a'));
+  BOOST_CHECK_EQUAL(reader.version(), 500);
+}
+
+BOOST_AUTO_TEST_CASE(test_warm_deactivation)
+{
+  Engine engine(engine_options::fully_optimized |
+                  engine_options::warm_deactivation,
+                4);
+
+  auto x = Var<bool>(true);
+  auto y = Var<int>(1);
+  auto z = Var<int>(2);
+
+  struct chain
+  {
+    static ref<int> of(const ref<int>& a, int n)
+    {
+      const auto b = core::Lift("incr", a, [](int v) { return v + 1; });
+      return n > 1 ? of(b, n - 1) : b;
+    }
+  };
+
+  const auto f = Main(If(x, chain::of(y, 100), chain::of(z, 100)));
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, 101);
+
+  x = false;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, 102);
+
+  // The retained branch is reactivated without recalculation
+  x = true;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, 101);
+  BOOST_CHECK_LT(introspect::num_updated_nodes(), 10);
+
+  // A changed dependency invalidates the retained values
+  x = false;
+  y = 11;
+  x = true;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, 111);
+  BOOST_CHECK_GT(introspect::num_updated_nodes(), 100);
+
+  // Expired values are recalculated
+  x = false;
+
+  for (int i = 0; i < 8; ++i)
+    z = *z + 1;
+
+  BOOST_CHECK_EQUAL(*f, 110);
+
+  x = true;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, 111);
+  BOOST_CHECK_GT(introspect::num_updated_nodes(), 100);
+
+  // A dependency that has lost its value invalidates the retained values,
+  // even if it calculates the same value as before
+  struct incr_policy
+  {
+    static std::string label()
+    {
+      return "incr";
+    }
+
+    static bool retainable()
+    {
+      return false;
+    }
+
+    int calculate(int v) const
+    {
+      return v + 1;
+    }
+  };
+
+  auto u = Var<bool>(true);
+  auto w = Var<int>(5);
+
+  const auto g = core::Lift<incr_policy>(w);
+  const auto h = Main(
+    If(u, core::Lift("mul", g, [](int v) { return v * 10; }), Const(-1)));
+
+  BOOST_CHECK_EQUAL(*h, 60);
+
+  u = false;
+  w = -1;
+  u = true;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*h, 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_Cast_double_to_int)
+{
+  EngineTest engine;
+
+  auto x = Var(3.14);
+  const auto y = Cast<int>(x);
+  const auto m = Main(y);
+
+  BOOST_CHECK_EQUAL(*m, 3);
+
+  x = 2.17;
+
+  BOOST_CHECK_EQUAL(*m, 2);
+
+  x = 4.99;
+
+  BOOST_CHECK_EQUAL(*m, 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_Main_ref_arg)
+{
+  EngineTest engine;
+
+  const var<int> x = Var<int>(6);
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(introspect::ref_count(x), 1);
+
+  const auto y = Main(x);
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(introspect::ref_count(x), 2);
+
+  BOOST_CHECK_EQUAL(introspect::label(y), "main");
+  BOOST_CHECK_EQUAL(*y, 6);
+}
+
+BOOST_AUTO_TEST_CASE(test_Main_init_func_arg)
+{
+  EngineTest engine;
+
+  var<int> x = Var<int>(6);
+
+  const auto y = Main([x = x.as_ref()](dtime t) { return x; });
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*y, 6);
+
+  x = 25;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*y, 25);
+}
+
+BOOST_AUTO_TEST_CASE(test_If_var_var_var)
+{
+  EngineTest engine;
+
+  auto x = Var<bool>(true);
+  auto y = Var<int>(10);
+  auto z = Var<int>(20);
+
+  auto f = Main(If(x, y, z));
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, 10);
+
+  x = false;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, 20);
+}
+
+BOOST_AUTO_TEST_CASE(test_If_var_int_var)
+{
+  EngineTest engine;
+
+  auto x = Var<bool>(true);
+  auto z = Var<int>(20);
+
+  auto f = Main(If(x, 10, z));
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, 10);
+
+  x = false;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, 20);
+}
+
+BOOST_AUTO_TEST_CASE(test_If_var_var_int)
+{
+  EngineTest engine;
+
+  auto x = Var<bool>(true);
+  auto y = Var<int>(10);
+
+  auto f = Main(If(x, y, 20));
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, 10);
+
+  x = false;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, 20);
+}
+
+BOOST_AUTO_TEST_CASE(test_If_var_int_int)
+{
+  EngineTest engine;
+
+  auto x = Var<bool>(true);
+
+  auto f = Main(If(x, 10, 20));
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, 10);
+
+  x = false;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, 20);
+}
+
+BOOST_AUTO_TEST_CASE(test_If_var_str_strliteral)
+{
+  EngineTest engine;
+
+  auto x = Var<bool>(true);
+
+  auto f = Main(If(x, std::string("str"), "strliteral"));
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, "str");
+
+  x = false;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, "strliteral");
+}
+
+BOOST_AUTO_TEST_CASE(test_If_fn_fn)
+{
+  EngineTest engine;
+
+  auto x = Var<bool>(true);
+  auto y = Var<int>(11);
+  auto z = Var<int>(12);
+
+  auto f = Main(If(
+    x,
+    [y = y.as_ref()](dtime t) { return y; },
+    [x = x.as_ref(), y = y.as_ref(), z = z.as_ref()](dtime t) {
+      return If(x, y, z);
+    }));
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(introspect::active_node(y), true);
+  BOOST_CHECK_EQUAL(introspect::active_node(z), false);
+  BOOST_CHECK_EQUAL(*f, 11);
+
+  y = 13;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, 13);
+
+  const auto count = introspect::num_active_nodes();
+
+  x = false;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(introspect::num_active_nodes(), count + 2);
+  BOOST_CHECK_EQUAL(introspect::active_node(y), false);
+  BOOST_CHECK_EQUAL(introspect::active_node(z), true);
+  BOOST_CHECK_EQUAL(*f, 12);
+
+  z = 14;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, 14);
+
+  x = true;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(introspect::num_active_nodes(), count);
+  BOOST_CHECK_EQUAL(introspect::active_node(y), true);
+  BOOST_CHECK_EQUAL(introspect::active_node(z), false);
+  BOOST_CHECK_EQUAL(*f, 13);
+}
+
+BOOST_AUTO_TEST_CASE(test_If_ref_fn)
+{
+  EngineTest engine;
+
+  auto x = Var<bool>(true);
+  auto y = Var<int>(11);
+  auto z = Var<int>(12);
+
+  auto f = Main(If(x, y, [z = z.as_ref()](dtime t0) { return z; }));
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(introspect::active_node(y), true);
+  BOOST_CHECK_EQUAL(introspect::active_node(z), false);
+  BOOST_CHECK_EQUAL(*f, 11);
+
+  y = 34;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, 34);
+
+  x = false;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(introspect::active_node(y), false);
+  BOOST_CHECK_EQUAL(introspect::active_node(z), true);
+  BOOST_CHECK_EQUAL(*f, 12);
+
+  z = 15;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, 15);
+}
+
+BOOST_AUTO_TEST_CASE(test_If_fn_ref)
+{
+  EngineTest engine;
+
+  auto x = Var<bool>(true);
+  auto y = Var<int>(11);
+  auto z = Var<int>(12);
+
+  auto f = Main(If(
+    x, [y = y.as_ref()](dtime t0) { return y; }, z));
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(introspect::active_node(y), true);
+  BOOST_CHECK_EQUAL(introspect::active_node(z), false);
+  BOOST_CHECK_EQUAL(*f, 11);
+
+  y = 34;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, 34);
 
   x = false;
 
@@ -926,6 +1953,46 @@ BOOST_AUTO_TEST_CASE(test_If_fn_ref)
   BOOST_CHECK_EQUAL(*f, 15);
 }
 
+BOOST_AUTO_TEST_CASE(test_If_long_branches)
+{
+  EngineTest engine;
+
+  auto x = Var<bool>(true);
+  auto y = Var<int>(1);
+  auto z = Var<int>(2);
+
+  struct chain
+  {
+    static ref<int> of(const ref<int>& a, int n)
+    {
+      const auto b = core::Lift("incr", a, [](int v) { return v + 1; });
+      return n > 1 ? of(b, n - 1) : b;
+    }
+  };
+
+  auto f = Main(If(
+    x,
+    [y = y.as_ref()](dtime t0) { return chain::of(y, 300); },
+    [z = z.as_ref()](dtime t0) { return chain::of(z, 300); }));
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, 301);
+
+  for (int i = 0; i < 10; ++i)
+  {
+    x = !(i % 2 == 0);
+
+    BOOST_CHECK(graph_invariant_holds());
+    BOOST_CHECK_EQUAL(*f, i % 2 == 0 ? 302 + i : 301 + i);
+
+    y = *y + 1;
+    z = *z + 1;
+
+    BOOST_CHECK(graph_invariant_holds());
+    BOOST_CHECK_EQUAL(*f, i % 2 == 0 ? 303 + i : 302 + i);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(test_If_fn_fn_eagerness)
 {
   EngineTest engine;
@@ -678,5 +678,109 @@ BOOST_AUTO_TEST_CASE(test_LiftPatcher_generic_patch)
   BOOST_CHECK_EQUAL(*z, 0);
 }
 
+BOOST_AUTO_TEST_CASE(test_LiftPatcher_var_patched_twice_in_Transaction)
+{
+  EngineTest engine;
+
+  class data_var : public core::var_base<data>
+  {
+  public:
+    explicit data_var(core::var_base<data>&& other)
+    : core::var_base<data>(std::move(other))
+    {
+    }
+
+    void add(int diff)
+    {
+      this->set_patch_(patch{diff});
+    }
+
+    void set(const data& v)
+    {
+      this->set_value_(v);
+    }
+  };
+
+  patcher_test_counters transform_data_counters;
+
+  data_var x(Var<data>(data{1}));
+
+  auto f = Main(TransformData(transform_data_counters, x, Var<int>(0)));
+
+  BOOST_CHECK_EQUAL(*f, data{1});
+  BOOST_CHECK_EQUAL(transform_data_counters, patcher_test_counters(1, 0));
+
+  // The consumer gets the whole change instead of one of the patches
+  {
+    const Transaction tx;
+
+    x.add(10);
+    x.add(100);
+  }
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, data{111});
+  BOOST_CHECK_EQUAL(transform_data_counters, patcher_test_counters(1, 1, 1));
+
+  x.add(1);
+
+  BOOST_CHECK_EQUAL(*f, data{112});
+  BOOST_CHECK_EQUAL(transform_data_counters, patcher_test_counters(1, 2, 1));
+
+  {
+    const Transaction tx;
+
+    x.add(5);
+    x.set(data{0});
+  }
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, data{0});
+  BOOST_CHECK_EQUAL(transform_data_counters, patcher_test_counters(1, 3, 2));
+}
+
+BOOST_AUTO_TEST_CASE(test_LiftPatcher_var_patched_then_drained_in_Transaction)
+{
+  EngineTest engine;
+
+  class data_var : public core::var_base<data>
+  {
+  public:
+    explicit data_var(core::var_base<data>&& other)
+    : core::var_base<data>(std::move(other))
+    {
+    }
+
+    void add(int diff)
+    {
+      this->set_patch_(patch{diff});
+    }
+  };
+
+  patcher_test_counters transform_data_counters;
+
+  auto v = Var<data>(data{1});
+  data_var x{var<data>(v)};
+
+  auto f = Main(TransformData(transform_data_counters, x, Var<int>(0)));
+
+  BOOST_CHECK_EQUAL(*f, data{1});
+  BOOST_CHECK_EQUAL(transform_data_counters, patcher_test_counters(1, 0));
+
+  // The posted value replaces the patched one, so the patch is dropped
+  {
+    const Transaction tx;
+
+    x.add(10);
+
+    engine.Post(v, data{5});
+    engine.Drain();
+  }
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*f, data{5});
+  BOOST_CHECK_EQUAL(transform_data_counters, patcher_test_counters(1, 1, 1));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 }
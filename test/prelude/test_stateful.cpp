@@ -127,7 +127,7 @@ BOOST_AUTO_TEST_CASE(test_StateMachine_num_vertices_refs)
   }));
 
   // TODO: calculate and illustrate how many nodes are really needed
-  BOOST_CHECK_EQUAL(introspect::num_vertices(), 27);
+  BOOST_CHECK_EQUAL(introspect::num_vertices(), 12);
 }
 
 BOOST_AUTO_TEST_CASE(test_StateMachine_num_vertices_fots)
@@ -143,7 +143,7 @@ BOOST_AUTO_TEST_CASE(test_StateMachine_num_vertices_fots)
   }));
 
   // TODO: calculate and illustrate how many nodes are really needed
-  BOOST_CHECK_EQUAL(introspect::num_vertices(), 39);
+  BOOST_CHECK_EQUAL(introspect::num_vertices(), 12);
 }
 
 BOOST_AUTO_TEST_CASE(test_StateMachine_refs)
@@ -388,6 +388,37 @@ BOOST_AUTO_TEST_CASE(test_Prev_overloads)
 
 // Backward finite difference
 
+BOOST_AUTO_TEST_CASE(test_Prev_constant_v0)
+{
+  Engine engine;
+
+  io_fixture io;
+
+  var<int> x = Var<int>(3);
+
+  io.capture_output();
+
+  const auto z = Main([x = x.as_ref()](dtime t0) {
+    return introspect::Log(Prev(1, x, t0), "prev");
+  });
+
+  io.reset_output();
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(introspect::num_vertices(), 5);
+  BOOST_CHECK_EQUAL(io.log_string(), "[t=0] prev = 1;[t=1] prev = 3;");
+
+  io.capture_output();
+
+  x = 5; // t=2
+
+  io.reset_output();
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(io.log_string(),
+                    "[t=0] prev = 1;[t=1] prev = 3;[t=3] prev = 5;");
+}
+
 BOOST_AUTO_TEST_CASE(test_Diff)
 {
   Engine engine;
@@ -469,6 +500,92 @@ BOOST_AUTO_TEST_CASE(test_Diff_mixed_types)
                     "[t=0] diff = 0;[t=2] diff = -2;[t=3] diff = 0;");
 }
 
+BOOST_AUTO_TEST_CASE(test_Accumulate)
+{
+  Engine engine;
+
+  io_fixture io;
+
+  var<int> x = Var<int>(3);
+
+  io.capture_output();
+
+  const auto z = Main([x = x.as_ref()](dtime) {
+    return introspect::Log(
+      Accumulate(x, [](int acc, int v) { return acc + v; }, 10), "acc");
+  });
+
+  io.reset_output();
+
+  BOOST_CHECK_EQUAL(io.log_string(), "[t=0] acc = 13;");
+
+  io.capture_output();
+
+  x = 5;  // t=1
+  x = -8; // t=2
+
+  io.reset_output();
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(io.log_string(),
+                    "[t=0] acc = 13;[t=1] acc = 18;[t=2] acc = 10;");
+}
+
+BOOST_AUTO_TEST_CASE(test_Accumulate_warm_deactivation)
+{
+  Engine engine(engine_options::fully_optimized |
+                engine_options::warm_deactivation);
+
+  auto x = Var<bool>(true);
+  auto y = Var<int>(1);
+
+  const auto z = Main(
+    If(x, Accumulate(y, [](int acc, int v) { return acc + v; }, 0), Const(-1)));
+
+  y = 2;
+
+  BOOST_CHECK_EQUAL(*z, 3);
+
+  // The accumulated value is not retained
+  x = false;
+  x = true;
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(*z, 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_Hold)
+{
+  Engine engine;
+
+  io_fixture io;
+
+  var<int> x = Var<int>(3);
+  var<bool> trigger = Var<bool>(false);
+
+  io.capture_output();
+
+  const auto z = Main([x = x.as_ref(), trigger = trigger.as_ref()](dtime) {
+    return introspect::Log(Hold(x, trigger), "hold");
+  });
+
+  io.reset_output();
+
+  BOOST_CHECK_EQUAL(io.log_string(), "[t=0] hold = 3;");
+
+  io.capture_output();
+
+  x = 5;          // t=1
+  trigger = true; // t=2
+  x = 7;          // t=3
+
+  io.reset_output();
+
+  BOOST_CHECK(graph_invariant_holds());
+  BOOST_CHECK_EQUAL(io.log_string(),
+                    "[t=0] hold = 3;[t=2] hold = 5;[t=3] hold = 7;");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // dataflow_test
@@ -0,0 +1,87 @@
+
+//  Copyright (c) 2014 - 2020 Maksym V. Bilinets.
+//
+//  This file is part of Dataflow++.
+//
+//  Dataflow++ is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  Dataflow++ is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public License
+//  along with Dataflow++. If not, see <http://www.gnu.org/licenses/>.
+#include <dataflow/expression.h>
+
+#include <dataflow/introspect.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace dataflow;
+
+namespace dataflow_test
+{
+
+BOOST_AUTO_TEST_SUITE(test_expression)
+
+BOOST_AUTO_TEST_CASE(test_expression_single_node)
+{
+  Engine engine;
+
+  auto a = Var<int>(1);
+  auto b = Var<int>(2);
+  auto c = Var<int>(3);
+  auto d = Var<int>(8);
+
+  const auto m = Main(((Expr(a) + b) * c > d).as_ref());
+
+  BOOST_CHECK_EQUAL(*m, true);
+  BOOST_CHECK_EQUAL(introspect::label(m), "main");
+
+  // Four variables, the expression and the nodes behind `Main`
+  BOOST_CHECK_EQUAL(introspect::num_active_nodes(), 7);
+
+  d = 10;
+
+  BOOST_CHECK_EQUAL(*m, false);
+  BOOST_CHECK_EQUAL(introspect::num_updated_nodes(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_expression_literals)
+{
+  Engine engine;
+
+  auto a = Var<int>(7);
+  auto b = Var<int>(2);
+
+  const ref<int> x = -(10 - Expr(a)) % b;
+  const ref<bool> y = !(Expr(a) == 7) || 2 * b != 4;
+
+  const auto m = Main(x);
+  const auto n = Main(y);
+
+  BOOST_CHECK_EQUAL(*m, -1);
+  BOOST_CHECK_EQUAL(*n, false);
+  BOOST_CHECK_EQUAL(introspect::label(x), "expression");
+
+  a = 4;
+
+  BOOST_CHECK_EQUAL(*m, 0);
+  BOOST_CHECK_EQUAL(*n, true);
+}
+
+BOOST_AUTO_TEST_CASE(test_expression_without_arguments)
+{
+  Engine engine;
+
+  const auto x = Expr(Const(3)) * 2 + 1;
+
+  BOOST_CHECK_EQUAL(*Main(x.as_ref()), 7);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}
@@ -110,6 +110,30 @@ BOOST_AUTO_TEST_CASE(test_listC_Var_insert_inactive)
   BOOST_CHECK_EQUAL(core::to_string(*f), "list(1 2)");
 }
 
+BOOST_AUTO_TEST_CASE(test_listC_Var_insert_Transaction)
+{
+  Engine engine;
+
+  auto xs = Var<listC<int>>(1);
+
+  const auto f = Main(Insert(xs, Var(1), 100));
+
+  BOOST_CHECK_EQUAL(core::to_string(*f), "list(1 100)");
+
+  {
+    const Transaction tx;
+
+    xs.insert(0, 0);
+    xs.insert(2, 2);
+  }
+
+  BOOST_CHECK_EQUAL(core::to_string(*f), "list(0 100 1 2)");
+
+  xs.erase(0);
+
+  BOOST_CHECK_EQUAL(core::to_string(*f), "list(1 100 2)");
+}
+
 BOOST_AUTO_TEST_CASE(test_listC_Var_prepend_inactive)
 {
   Engine engine;
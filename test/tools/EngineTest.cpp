@@ -34,6 +34,18 @@ dataflow::engine_options get_options()
     {
       return dataflow::engine_options::nothing;
     }
+
+    if (std::string(test_suit.argv[1]) == "--parallel-update")
+    {
+      return dataflow::engine_options::fully_optimized |
+             dataflow::engine_options::parallel_update;
+    }
+
+    if (std::string(test_suit.argv[1]) == "--frozen-graph")
+    {
+      return dataflow::engine_options::fully_optimized |
+             dataflow::engine_options::frozen_graph;
+    }
   }
 
   return dataflow::engine_options::fully_optimized;